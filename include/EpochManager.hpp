@@ -0,0 +1,380 @@
+#ifndef EPOCH_MANAGER
+#define EPOCH_MANAGER
+
+#include <cassert>
+#include <cstdlib>
+#include <new>
+#include <algorithm>
+#include <atomic>
+
+#include "Utils.hpp"
+#include "ThreadRegistry.hpp"
+#include "SlabArena.hpp"
+#include "Reclaimer.hpp"
+
+/*!
+ * A manager for Epoch-Based Reclamation.
+ * Instead of publishing each node it reads, a thread announces the global epoch once when
+ * it enters an operation. A node released during epoch e is reused only once the global
+ * epoch has reached e + 2, at which point every thread that was in an operation when the
+ * node was released has left it. It has the same interface as HazardManager, publish()
+ * and release() doing nothing. Like HazardManager, it shares the surplus of free nodes
+ * of each thread through a pool per NUMA node and destroys them above its high-water mark.
+ * \param Node The type of node to manage.
+ * \param Threads The number of records allocated at first, more threads can be attached.
+ * \param Size Unused, only there to have the same parameters as HazardManager.
+ * \param Prefill The number of nodes to reserve in the arena of each thread.
+ */
+template<typename Node, unsigned int Threads, unsigned int Size = 2, unsigned int Prefill = 50>
+class EpochManager {
+    public:
+        EpochManager();
+        ~EpochManager();
+
+        EpochManager(const EpochManager& rhs) = delete;
+        EpochManager& operator=(const EpochManager& rhs) = delete;
+
+        /*!
+         * Release the node. It is reused two epochs later.
+         */
+        void releaseNode(Node* node);
+
+        /*!
+         * \brief Release the node by checking first if it is not already released.
+         * This method can be slow depending on the number of nodes already released.
+         * \param node The node to release.
+         */
+        void safe_release_node(Node* node);
+
+        /*!
+         * Set the high-water mark of the free nodes. Above it, the surplus of free nodes of a
+         * thread is destroyed, so that the slabs whose nodes are all destroyed are given back
+         * to the system. Defaults to default_high_water.
+         * \param nodes The number of free nodes to keep for all the threads, 0 to keep all of them.
+         */
+        void setHighWater(unsigned int nodes);
+
+        /*!
+         * Return the sum of the reclamation counters of all the threads. A scan is a collection
+         * of the limbo queues of a thread.
+         * The counters are read while the threads are running, so the snapshot is not atomic.
+         */
+        ReclamationStats stats();
+
+        /*!
+         * Indicates if the node has been allocated by a manager of this type.
+         * The node may already be free, or marked in its lowest bits, or null.
+         */
+        static bool carved(Node* node);
+
+        /*!
+         * Return a free node for the calling thread.
+         * \return A free node
+         */
+        Node* getFreeNode();
+
+        /*!
+         * Does nothing, the node is protected by the critical section.
+         */
+        void publish(Node* node, unsigned int i);
+
+        /*!
+         * Does nothing, the node is protected by the critical section.
+         */
+        void release(unsigned int i);
+
+        /*!
+         * Does nothing, the nodes are protected by the critical section.
+         */
+        void releaseAll();
+
+        /*!
+         * Enter a critical section: announce the current epoch for the calling thread.
+         * The critical sections can be nested, only the outermost one announces the epoch.
+         */
+        void enter();
+
+        /*!
+         * Leave the critical section of the calling thread.
+         */
+        void exit();
+
+    private:
+        /*!
+         * All the state of a single thread.
+         */
+        struct ThreadRecord {
+            std::atomic<unsigned long> State;   //The announced epoch shifted by one, the low bit indicates an operation in progress
+            unsigned int Depth;                 //Number of nested critical sections
+            NodeQueue<Node> LimboQueues[3];     //The released nodes, by epoch modulo 3
+            unsigned long LimboEpochs[3];       //The epoch of the nodes of each limbo queue
+            NodeQueue<Node> FreeQueue;
+            SlabArena<Node> Arena;
+            bool Prefilled;                     //The arena is prefilled by the thread itself, on its NUMA node
+            ReclamationCounters Counters;
+
+            ThreadRecord(){
+                State.store(0);
+                Depth = 0;
+
+                for(unsigned int i = 0; i < 3; ++i){
+                    LimboEpochs[i] = i;
+                }
+
+                Prefilled = false;
+            }
+        };
+
+        std::atomic<unsigned long> Epoch;
+
+        ThreadTable<ThreadRecord> Records;
+
+        /*!
+         * Number of nodes moved at once between the free queue of a thread and the pool.
+         */
+        static const unsigned int PoolBatch = 32;
+
+        NumaNodePool<Node> Pool;
+
+        unsigned int HighWater;
+
+        ThreadRecord& record(unsigned int tid);
+
+        /*!
+         * Number of nodes waiting in the limbo queues of a thread before it tries to advance the epoch.
+         */
+        unsigned int advanceThreshold() const;
+
+        /*!
+         * Advance the global epoch if all the threads in an operation have announced it.
+         */
+        void tryAdvance();
+
+        /*!
+         * Move the limbo queues of the given thread that are at least two epochs old to its free queue.
+         */
+        void collect(ThreadRecord& thread);
+
+        /*!
+         * Give the free nodes of the given thread to the pool, except a batch for its own use.
+         * If the pool is full, destroy the nodes above the share of the thread of the high-water mark.
+         */
+        void share(ThreadRecord& thread, unsigned int tid);
+
+        /* Verify the template parameters */
+        static_assert(Threads > 0, "The number of threads must be greater than 0");
+};
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+EpochManager<Node, Threads, Size, Prefill>::EpochManager() : Records(Threads), HighWater(default_high_water) {
+    Epoch.store(0);
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+EpochManager<Node, Threads, Size, Prefill>::~EpochManager(){
+    //All the nodes are destroyed with the arenas
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+inline typename EpochManager<Node, Threads, Size, Prefill>::ThreadRecord& EpochManager<Node, Threads, Size, Prefill>::record(unsigned int tid){
+#ifdef DEBUG
+    assert(tid < thread_slots());
+#endif
+
+    return Records[tid];
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+inline unsigned int EpochManager<Node, Threads, Size, Prefill>::advanceThreshold() const {
+    return 2 * Records.capacity();
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+void EpochManager<Node, Threads, Size, Prefill>::enter(){
+    ThreadRecord& thread = record(thread_num);
+
+    if(thread.Depth++ == 0){
+        //Sequentially consistent, the announce must be visible before any node is read
+        thread.State.store((Epoch.load() << 1) | 1);
+    }
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+void EpochManager<Node, Threads, Size, Prefill>::exit(){
+    ThreadRecord& thread = record(thread_num);
+
+    if(--thread.Depth == 0){
+        thread.State.store(thread.State.load(std::memory_order_relaxed) & ~1ul, std::memory_order_release);
+    }
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+void EpochManager<Node, Threads, Size, Prefill>::releaseNode(Node* node){
+    //If the node is null, we have nothing to do
+    if(node){
+        int tid = thread_num;
+        ThreadRecord& thread = record(tid);
+
+        unsigned long epoch = Epoch.load();
+        unsigned int index = epoch % 3;
+
+        //The queue still contains nodes of epoch - 3 or older, they are already safe
+        if(thread.LimboEpochs[index] != epoch){
+            thread.Counters.reclaim(thread.LimboQueues[index].size());
+
+            thread.FreeQueue.append(thread.LimboQueues[index]);
+            thread.LimboEpochs[index] = epoch;
+        }
+
+        thread.LimboQueues[index].push_back(node);
+
+        //If there are enough released nodes, try to make some of them safe
+        unsigned int released = thread.LimboQueues[0].size() + thread.LimboQueues[1].size() + thread.LimboQueues[2].size();
+        thread.Counters.retire(released);
+
+        if(released >= advanceThreshold()){
+            tryAdvance();
+            collect(thread);
+            share(thread, tid);
+        }
+    }
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+void EpochManager<Node, Threads, Size, Prefill>::safe_release_node(Node* node){
+    if(node){
+        ThreadRecord& thread = record(thread_num);
+
+        for(unsigned int i = 0; i < 3; ++i){
+            if(thread.LimboQueues[i].contains(node)){
+                return;
+            }
+        }
+
+        releaseNode(node);
+    }
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+void EpochManager<Node, Threads, Size, Prefill>::setHighWater(unsigned int nodes){
+    HighWater = nodes;
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+bool EpochManager<Node, Threads, Size, Prefill>::carved(Node* node){
+    return SlabArena<Node>::carved(node);
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+ReclamationStats EpochManager<Node, Threads, Size, Prefill>::stats(){
+    ReclamationStats stats;
+
+    Records.for_each([&stats](ThreadRecord& thread){
+        thread.Counters.snapshot(stats);
+    });
+
+    return stats;
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+Node* EpochManager<Node, Threads, Size, Prefill>::getFreeNode(){
+    int tid = thread_num;
+    ThreadRecord& thread = record(tid);
+
+    //The records are constructed by the thread creating the manager, the first slab must be mapped by the owner
+    if(!thread.Prefilled){
+        thread.Arena.reserve(Prefill);
+        thread.Prefilled = true;
+    }
+
+    //First, try to get a free node from the free queue
+    if(!thread.FreeQueue.empty()){
+        return thread.FreeQueue.pop_front();
+    }
+
+    //Then, take back nodes given by the other threads
+    if(Pool.steal(thread.FreeQueue, tid)){
+        return thread.FreeQueue.pop_front();
+    }
+
+    //There was no way to get a free node, carve a new one from the arena
+    thread.Counters.allocate();
+
+    return thread.Arena.allocate();
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+void EpochManager<Node, Threads, Size, Prefill>::tryAdvance(){
+    unsigned long epoch = Epoch.load();
+    bool late = false;
+
+    Records.for_each([epoch, &late](ThreadRecord& other){
+        unsigned long state = other.State.load();
+
+        //A thread is still in an operation started in a previous epoch
+        if((state & 1) && (state >> 1) != epoch){
+            late = true;
+        }
+    });
+
+    if(!late){
+        Epoch.compare_exchange_strong(epoch, epoch + 1);
+    }
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+void EpochManager<Node, Threads, Size, Prefill>::collect(ThreadRecord& thread){
+    unsigned long epoch = Epoch.load();
+    unsigned int collected = 0;
+
+    for(unsigned int i = 0; i < 3; ++i){
+        if(thread.LimboEpochs[i] + 2 <= epoch){
+            collected += thread.LimboQueues[i].size();
+            thread.FreeQueue.append(thread.LimboQueues[i]);
+        }
+    }
+
+    thread.Counters.scan(collected);
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+void EpochManager<Node, Threads, Size, Prefill>::share(ThreadRecord& thread, unsigned int tid){
+    while(thread.FreeQueue.size() >= 2 * PoolBatch && Pool.push(thread.FreeQueue, PoolBatch, tid)){
+        //Continue until the pool is full
+    }
+
+    if(HighWater){
+        unsigned int keep = std::max(HighWater / Records.capacity(), 2 * PoolBatch);
+
+        while(thread.FreeQueue.size() > keep){
+            SlabArena<Node>::destroy(thread.FreeQueue.pop_front());
+        }
+    }
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+inline void EpochManager<Node, Threads, Size, Prefill>::publish(Node* /*node*/, unsigned int /*i*/){
+    //Nothing to do
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+inline void EpochManager<Node, Threads, Size, Prefill>::release(unsigned int /*i*/){
+    //Nothing to do
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+inline void EpochManager<Node, Threads, Size, Prefill>::releaseAll(){
+    //Nothing to do
+}
+
+/*!
+ * Reclamation policy protecting all the nodes read by an operation with an epoch.
+ */
+struct Epochs {};
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+struct Reclaimer<Epochs, Node, Threads, Size, Prefill> {
+    typedef EpochManager<Node, Threads, Size, Prefill> type;
+};
+
+#endif
@@ -3,23 +3,135 @@
 
 #include <cassert>
 
-//#define DEBUG //Indicates that the at() function is used for array accesses
+//#define DEBUG //Indicates that the thread ids and the hazard pointers indices are checked
+//#define SYMMETRIC_FENCES //Indicates that each publication is followed by a full fence even if membarrier() is available
 
-//Thread local id
-//Note: __thread is GCC specific
-extern __thread unsigned int thread_num;
+//Indicates that the process is registered for expedited membarrier()
+extern const bool asymmetric_fences;
 
-#include <list>
-#include <array>
+/*!
+ * Execute a memory barrier on all the running threads of the process.
+ * Only valid if asymmetric_fences is true.
+ */
+void heavy_fence();
+
+/*!
+ * Order a publication before the following loads of the calling thread. 
+ * With asymmetric fences, a compiler barrier is enough, the scanning thread 
+ * issuing a heavy_fence() on behalf of all the threads. 
+ */
+inline void light_fence(){
+#ifndef SYMMETRIC_FENCES
+    if(asymmetric_fences){
+        asm volatile("" ::: "memory");
+        return;
+    }
+#endif
+
+    __sync_synchronize();
+}
+
+#include <cstdlib>
+#include <new>
 #include <algorithm>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <utility>
 #include <iostream>
 
+#include "Utils.hpp"
+#include "ThreadRegistry.hpp"
+#include "SlabArena.hpp"
+#include "Reclaimer.hpp"
+
+//Indicates that the hazard managers created from now on reclaim the nodes on a helper thread
+extern bool background_reclamation;
+
+/*!
+ * The helper thread reclaiming the nodes of all the hazard managers created with background_reclamation. 
+ * It is started with the first of them. Each time it is woken up, it runs the reclamation of every 
+ * manager, then parks on a futex until a thread wakes it up again, so an idle helper costs nothing. 
+ */
+class ReclamationHelper {
+    public:
+        /*!
+         * Return the helper of the process, started at the first call. 
+         */
+        static ReclamationHelper& instance();
+
+        ReclamationHelper(const ReclamationHelper& rhs) = delete;
+        ReclamationHelper& operator=(const ReclamationHelper& rhs) = delete;
+
+        /*!
+         * Run the given reclamation on the helper thread each time the helper is woken up. 
+         * \param owner The manager of the reclamation, used to remove it. 
+         * \param reclamation The reclamation of the manager. 
+         */
+        void add(const void* owner, std::function<void()> reclamation);
+
+        /*!
+         * Stop running the reclamation of the given manager. The reclamation is not running anymore 
+         * when the function returns, so the manager can be destroyed. 
+         * \param owner The manager of the reclamation. 
+         */
+        void remove(const void* owner);
+
+        /*!
+         * Wake the helper up. Lock-free, only costs a system call if the helper is parked. 
+         */
+        void wake();
+
+    private:
+        ReclamationHelper();
+        ~ReclamationHelper();
+
+        /*!
+         * Main loop of the helper thread. 
+         */
+        void run();
+
+        //The states of the helper, State is also the word it parks on
+        static const int Running = 0;
+        static const int Woken = 1;
+        static const int Parked = 2;
+
+        std::atomic<int> State;
+        std::atomic<bool> Stop;
+        std::mutex Lock;                //Protects the reclamations, held while they run
+        std::vector<std::pair<const void*, std::function<void()>>> Reclamations;
+        std::thread Thread;
+};
+
 /*!
  * A manager for Hazard Pointers manipulation. 
+ * The nodes are carved from per-thread slab arenas and the released and free nodes are
+ * chained through an intrusive link, so no memory is allocated once the arenas are warm. 
+ * The surplus of free nodes of a thread is given by batches to a pool shared by all the
+ * threads of its NUMA node, so that the threads that mostly insert reuse the nodes released 
+ * by the threads that mostly remove without reading the memory of another node. Above the 
+ * high-water mark, the surplus is destroyed instead, so that the slabs whose nodes are all 
+ * destroyed are given back to the system. As the structures may still read a free node 
+ * without protecting it, the surplus is only destroyed once all the operations running 
+ * when it was put aside have ended. 
+ * All the state of a thread (hazard pointers, queues and arena) is kept in its own 
+ * cache-line-aligned record of a ThreadTable, so that publishing a reference never 
+ * invalidates the lines of the other threads. 
+ * When the kernel supports it, a publication only costs a compiler barrier, the full 
+ * fence being paid by the scanning thread with a process-wide membarrier(). 
+ * If background_reclamation is set when the manager is created, the threads do not scan 
+ * the hazard pointers themselves. They hand their released nodes by batches to the 
+ * ReclamationHelper of the process, that scans them and gives the free nodes to the pool. 
+ * A thread only scans when the helper is late and the batches cannot be handed. With a 
+ * high-water mark, the helper keeps no more free nodes than a thread: above its share, it 
+ * leaves the batches waiting, so that the threads scan themselves once the hand-off is full. 
  * \param Node The type of node to manage. 
- * \param Threads The maximum number of threads. 
+ * \param Threads The number of records allocated at first, more threads can be attached. 
  * \param Size The number of hazard pointers per thread. 
- * \param Prefill The number of nodes to precreate in the queue.
+ * \param Prefill The number of nodes to reserve in the arena of each thread.
  */
 template<typename Node, unsigned int Threads, unsigned int Size = 2, unsigned int Prefill = 50>
 class HazardManager {
@@ -38,10 +150,31 @@ class HazardManager {
         /*!
          * \brief Release the node by checking first if it is not already in the queue. 
          * This method can be slow depending on the number of nodes already released. 
+         * The nodes already handed to the helper thread are not checked. 
          * \param node The node to release. 
          */
         void safe_release_node(Node* node);
 
+        /*!
+         * Set the high-water mark of the free nodes. Above it, the surplus of free nodes of a 
+         * thread is destroyed, so that the slabs whose nodes are all destroyed are given back 
+         * to the system. Defaults to default_high_water. Must be set before the manager is used. 
+         * \param nodes The number of free nodes to keep for all the threads, 0 to keep all of them. 
+         */
+        void setHighWater(unsigned int nodes);
+
+        /*!
+         * Return the sum of the reclamation counters of all the threads. 
+         * The counters are read while the threads are running, so the snapshot is not atomic. 
+         */
+        ReclamationStats stats();
+
+        /*!
+         * Indicates if the node has been allocated by a manager of this type. 
+         * The node may already be free, or marked in its lowest bits, or null. 
+         */
+        static bool carved(Node* node);
+
         /*!
          * Return a free node for the calling thread. 
          * \return A free node
@@ -67,109 +200,168 @@ class HazardManager {
         void releaseAll();
 
         /*!
-         * Return a reference to the internal free queue of the given thread. 
-         * \return A reference to the free queue of the given thread. 
+         * Start an operation of the calling thread. 
+         * The nodes are protected one by one with publish(), the operations are only counted 
+         * with a high-water mark, to know when the surplus of free nodes can be destroyed. 
          */
-        std::list<Node*>& direct_free(unsigned int t);
+        void enter();
 
         /*!
-         * Return a reference to the internal local queue of the given thread. 
-         * \return A reference to the local queue of the given thread. 
+         * End an operation of the calling thread. 
          */
-        std::list<Node*>& direct_local(unsigned int t);
+        void exit();
 
     private:
-        std::array<std::array<Node*, Size>, Threads> Pointers;
-        std::array<std::list<Node*>, Threads> LocalQueues;
-        std::array<std::list<Node*>, Threads> FreeQueues;
+        /*!
+         * All the state of a single thread. 
+         */
+        struct ThreadRecord {
+            Node* Pointers[Size];
+            NodeQueue<Node> LocalQueue;
+            NodeQueue<Node> FreeQueue;
+            SlabArena<Node> Arena;
+            bool Prefilled;                 //The arena is prefilled by the thread itself, on its NUMA node
+            std::vector<Node*> Snapshot;    //Kept to not allocate at each scan
+            ReclamationCounters Counters;
+
+            std::atomic<unsigned long> Operations;      //Number of operations started and ended, odd during an operation
+            unsigned int Depth;                         //Number of nested operations
+            NodeQueue<Node> DoomedQueue;                //The surplus of free nodes waiting to be destroyed
+            std::vector<unsigned long> DoomedOperations; //The operations of all the threads when the surplus was put aside
+
+            ThreadRecord(){
+                for(unsigned int i = 0; i < Size; ++i){
+                    Pointers[i] = nullptr;
+                }
+
+                Operations.store(0);
+                Depth = 0;
+                Prefilled = false;
+            }
+        };
+
+        ThreadTable<ThreadRecord> Records;
+
+        /*!
+         * Number of nodes moved at once between the free queue of a thread and the pool. 
+         */
+        static const unsigned int PoolBatch = 32;
+
+        NumaNodePool<Node> Pool;
+
+        unsigned int HighWater;
+
+        /*!
+         * Number of batches of released nodes that can wait for the helper thread. 
+         */
+        static const unsigned int HandedBatches = 256;
+
+        NodePool<Node, HandedBatches> Handed;           //The batches of released nodes handed to the helper
+        std::unique_ptr<ThreadRecord> HelperRecord;     //The queues of the helper, null without helper
+        std::atomic<bool> Waiting;                      //Indicates that batches wait for the helper
+        ReclamationHelper* Helper;                      //Null without helper
+
+        /*!
+         * Run on the helper thread: scan the handed nodes and share the free ones. 
+         */
+        void reclaim();
+
+        /*!
+         * Number of free nodes a thread keeps under the high-water mark. 
+         */
+        unsigned int keptNodes() const;
+
+        /*!
+         * Number of released nodes a thread accumulates before scanning the hazard pointers. 
+         * Twice the total number of hazard pointers, so that each scan frees at least as many 
+         * nodes as there are hazard pointers and its cost is amortized over them. 
+         */
+        unsigned int scanThreshold() const;
+
+        /*!
+         * Under this number of hazard pointers, it is faster to directly compare the
+         * nodes to the pointers than to take a sorted snapshot of them. 
+         */
+        static const unsigned int LinearScanSlots = 8;
+
+        ThreadRecord& record(unsigned int tid);
         
         bool isReferenced(Node* node);
 
+        /*!
+         * Move all the nodes of the local queue of the given thread that are not 
+         * referenced by any hazard pointer to its free queue. 
+         * \param thread The thread whose local queue is scanned. 
+         */
+        void scan(ThreadRecord& thread);
+
+        /*!
+         * Give the free nodes of the given thread to the pool, except a batch for its own use. 
+         * If the pool is full, put aside the nodes above the share of the thread of the high-water mark 
+         * and destroy the nodes put aside previously if no thread can read them anymore. 
+         * \param thread The thread whose free queue is shared. 
+         * \param hint The first slot of the pool to try. 
+         */
+        void share(ThreadRecord& thread, unsigned int hint);
+
+        /*!
+         * Indicates if all the operations that were running when the doomed nodes of the given 
+         * thread were put aside have ended. 
+         */
+        bool doomedUnreachable(ThreadRecord& thread);
+
         /* Verify the template parameters */
         static_assert(Threads > 0, "The number of threads must be greater than 0");
         static_assert(Size > 0, "The number of hazard pointers must greater than 0");
 };
 
 template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
-HazardManager<Node, Threads, Size, Prefill>::HazardManager(){
-    for(unsigned int tid = 0; tid < Threads; ++tid){
-        for(unsigned int j = 0; j < Size; ++j){
-#ifdef DEBUG
-            Pointers.at(tid).at(j) = nullptr;
-#else
-            Pointers[tid][j] = nullptr;
-#endif
-        }
-
-        if(Prefill > 0){
-            for(unsigned int i = 0; i < Prefill; i++){
-#ifdef DEBUG
-                FreeQueues.at(tid).push_back(new Node());
-#else
-                FreeQueues[tid].push_back(new Node());
-#endif
-            }
-        } 
+HazardManager<Node, Threads, Size, Prefill>::HazardManager() : Records(Threads), HighWater(default_high_water), Helper(nullptr) {
+    //The records are created with their segment of the table, only the helper needs to know the manager
+    Waiting.store(false);
+
+    if(background_reclamation){
+        HelperRecord.reset(new ThreadRecord());
+        Helper = &ReclamationHelper::instance();
+        Helper->add(this, [this](){ reclaim(); });
     }
 }
 
 template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
 HazardManager<Node, Threads, Size, Prefill>::~HazardManager(){
-    for(unsigned int tid = 0; tid < Threads; ++tid){
-        //No need to delete Hazard Pointers because each thread need to release its published references
-
-#ifdef DEBUG
-        while(!LocalQueues.at(tid).empty()){
-            delete LocalQueues.at(tid).front();
-            LocalQueues.at(tid).pop_front();
-        }
-        
-        while(!FreeQueues.at(tid).empty()){
-            delete FreeQueues.at(tid).front();
-            FreeQueues.at(tid).pop_front();
-        }
-#else
-        while(!LocalQueues[tid].empty()){
-            delete LocalQueues[tid].front();
-            LocalQueues[tid].pop_front();
-        }
-        
-        while(!FreeQueues[tid].empty()){
-            delete FreeQueues[tid].front();
-            FreeQueues[tid].pop_front();
-        }
-#endif
+    if(Helper){
+        Helper->remove(this);
     }
+
+    //No need to delete Hazard Pointers because each thread need to release its published references
+    //No need to empty the queues either, all the nodes are destroyed with the arenas
 }
-        
+
 template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
-std::list<Node*>& HazardManager<Node, Threads, Size, Prefill>::direct_free(unsigned int t){
+inline typename HazardManager<Node, Threads, Size, Prefill>::ThreadRecord& HazardManager<Node, Threads, Size, Prefill>::record(unsigned int tid){
 #ifdef DEBUG
-    return FreeQueues.at(t);
-#else
-    return FreeQueues[t];
+    assert(tid < thread_slots());
 #endif
+
+    return Records[tid];
 }
-        
+
 template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
-std::list<Node*>& HazardManager<Node, Threads, Size, Prefill>::direct_local(unsigned int t){
-#ifdef DEBUG
-    return LocalQueues.at(t);
-#else
-    return LocalQueues[t];
-#endif
+inline unsigned int HazardManager<Node, Threads, Size, Prefill>::scanThreshold() const {
+    return 2 * Records.capacity() * Size;
 }
 
 template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
 void HazardManager<Node, Threads, Size, Prefill>::safe_release_node(Node* node){
     //If the node is null, we have nothing to do
     if(node){
-        if(std::find(LocalQueues.at(thread_num).begin(), LocalQueues.at(thread_num).end(), node) != LocalQueues.at(thread_num).end()){
+        ThreadRecord& thread = record(thread_num);
+
+        if(thread.LocalQueue.contains(node)){
             return;
         }
 
-        //Add the node to the localqueue
-        LocalQueues.at(thread_num).push_back(node);
+        releaseNode(node);
     }
 }
 
@@ -177,138 +369,316 @@ template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Pr
 void HazardManager<Node, Threads, Size, Prefill>::releaseNode(Node* node){
     //If the node is null, we have nothing to do
     if(node){
-#ifdef DEBUG
-        //Add the node to the localqueue
-        LocalQueues.at(thread_num).push_back(node);
-#else
+        int tid = thread_num;
+        ThreadRecord& thread = record(tid);
+
         //Add the node to the localqueue
-        LocalQueues[thread_num].push_back(node);
-#endif
+        thread.LocalQueue.push_back(node);
+        thread.Counters.retire(thread.LocalQueue.size());
+
+        //Scan here and not when allocating, a thread that mostly removes would never free its nodes
+        if(thread.LocalQueue.size() >= scanThreshold()){
+            //Scan inline only if there is no helper or if it has too many batches waiting
+            if(!Helper){
+                scan(thread);
+                share(thread, tid);
+            } else {
+                if(!Handed.push(thread.LocalQueue, thread.LocalQueue.size(), tid)){
+                    scan(thread);
+                    share(thread, tid);
+                }
+
+                //Even late, the helper is woken up, it may wait for its surplus of free nodes to be destroyed
+                Waiting.store(true);
+                Helper->wake();
+            }
+        }
     }
 }
 
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+void HazardManager<Node, Threads, Size, Prefill>::setHighWater(unsigned int nodes){
+    HighWater = nodes;
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+bool HazardManager<Node, Threads, Size, Prefill>::carved(Node* node){
+    return SlabArena<Node>::carved(node);
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+ReclamationStats HazardManager<Node, Threads, Size, Prefill>::stats(){
+    ReclamationStats stats;
+
+    Records.for_each([&stats](ThreadRecord& thread){
+        thread.Counters.snapshot(stats);
+    });
+
+    if(HelperRecord){
+        HelperRecord->Counters.snapshot(stats);
+    }
+
+    return stats;
+}
+
 template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
 Node* HazardManager<Node, Threads, Size, Prefill>::getFreeNode(){
     int tid = thread_num;
+    ThreadRecord& thread = record(tid);
+
+    //The records are constructed by the thread creating the manager, the first slab must be mapped by the owner
+    if(!thread.Prefilled){
+        thread.Arena.reserve(Prefill);
+        thread.Prefilled = true;
+    }
 
-#ifdef DEBUG
     //First, try to get a free node from the free queue
-    if(!FreeQueues.at(tid).empty()){
-        Node* free = FreeQueues.at(tid).front();
-        FreeQueues.at(tid).pop_front();
+    if(!thread.FreeQueue.empty()){
+        return thread.FreeQueue.pop_front();
+    }
 
-        return free;
+    //Then, take back nodes given by the other threads
+    if(Pool.steal(thread.FreeQueue, tid)){
+        return thread.FreeQueue.pop_front();
     }
 
-    //If there are enough local nodes, move then to the free queue
-    if(LocalQueues.at(tid).size() > (Size + 1) * Threads){
-        typename std::list<Node*>::iterator it = LocalQueues.at(tid).begin();
-        typename std::list<Node*>::iterator end = LocalQueues.at(tid).end();
+    //There was no way to get a free node, carve a new one from the arena
+    thread.Counters.allocate();
+
+    return thread.Arena.allocate();
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+void HazardManager<Node, Threads, Size, Prefill>::scan(ThreadRecord& thread){
+    NodeQueue<Node>& local_queue = thread.LocalQueue;
+    NodeQueue<Node>& free_queue = thread.FreeQueue;
+
+    unsigned int waiting = local_queue.size();
+
+#ifndef SYMMETRIC_FENCES
+    //Make the publications of all the threads visible before reading them
+    if(asymmetric_fences){
+        heavy_fence();
+    }
+#endif
 
-        while(it != end){
-            if(!isReferenced(*it)){
-                FreeQueues.at(tid).push_back(*it);
+    if(Records.capacity() * Size <= LinearScanSlots){
+        for(unsigned int i = local_queue.size(); i > 0; --i){
+            Node* node = local_queue.pop_front();
 
-                it = LocalQueues.at(tid).erase(it);
+            if(!isReferenced(node)){
+                free_queue.push_back(node);
+            } else {
+                local_queue.push_back(node);
             }
-            else {
-                ++it;
+        }
+
+        thread.Counters.scan(waiting - local_queue.size());
+
+        return;
+    }
+
+    //Take a sorted snapshot of all the published pointers, each one is read only once
+    std::vector<Node*>& snapshot = thread.Snapshot;
+    snapshot.clear();
+
+    Records.for_each([&snapshot](ThreadRecord& other){
+        for(unsigned int i = 0; i < Size; ++i){
+            Node* pointer = other.Pointers[i];
+
+            if(pointer){
+                snapshot.push_back(pointer);
             }
         }
-        
-        Node* free = FreeQueues.at(tid).front();
-        FreeQueues.at(tid).pop_front();
+    });
+
+    std::sort(snapshot.begin(), snapshot.end());
 
-        return free;
+    for(unsigned int i = local_queue.size(); i > 0; --i){
+        Node* node = local_queue.pop_front();
+
+        if(!std::binary_search(snapshot.begin(), snapshot.end(), node)){
+            free_queue.push_back(node);
+        } else {
+            local_queue.push_back(node);
+        }
     }
-#else
-    //First, try to get a free node from the free queue
-    if(!FreeQueues[tid].empty()){
-        Node* free = FreeQueues[tid].front();
-        FreeQueues[tid].pop_front();
 
-        return free;
+    thread.Counters.scan(waiting - local_queue.size());
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+void HazardManager<Node, Threads, Size, Prefill>::share(ThreadRecord& thread, unsigned int hint){
+    NodeQueue<Node>& free_queue = thread.FreeQueue;
+
+    while(free_queue.size() >= 2 * PoolBatch && Pool.push(free_queue, PoolBatch, hint)){
+        //Continue until the pool is full
     }
 
-    //If there are enough local nodes, move then to the free queue
-    if(LocalQueues[tid].size() > (Size + 1) * Threads){
-        typename std::list<Node*>::iterator it = LocalQueues[tid].begin();
-        typename std::list<Node*>::iterator end = LocalQueues[tid].end();
+    if(HighWater){
+        NodeQueue<Node>& doomed_queue = thread.DoomedQueue;
+
+        if(!doomed_queue.empty() && doomedUnreachable(thread)){
+            while(!doomed_queue.empty()){
+                SlabArena<Node>::destroy(doomed_queue.pop_front());
+            }
+        }
 
-        while(it != end){
-            if(!isReferenced(*it)){
-                FreeQueues[tid].push_back(*it);
+        unsigned int keep = keptNodes();
 
-                it = LocalQueues[tid].erase(it);
+        //Only one batch is waiting at a time, the next surplus stays free until it is destroyed
+        if(doomed_queue.empty() && free_queue.size() > keep){
+            while(free_queue.size() > keep){
+                doomed_queue.push_back(free_queue.pop_front());
             }
-            else {
-                ++it;
+
+#ifndef SYMMETRIC_FENCES
+            //Make the start of the operations of all the threads visible before reading them
+            if(asymmetric_fences){
+                heavy_fence();
             }
-        }
-        
-        Node* free = FreeQueues[tid].front();
-        FreeQueues[tid].pop_front();
+#endif
+
+            std::vector<unsigned long>& operations = thread.DoomedOperations;
+            operations.clear();
 
-        return free;
+            Records.for_each([&operations](ThreadRecord& other){
+                operations.push_back(other.Operations.load());
+            });
+        }
     }
-#endif
+}
 
-    //There was no way to get a free node, allocate a new one
-    return new Node();
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+bool HazardManager<Node, Threads, Size, Prefill>::doomedUnreachable(ThreadRecord& thread){
+    std::vector<unsigned long>& operations = thread.DoomedOperations;
+    unsigned int i = 0;
+    bool unreachable = true;
+
+    //The records of the threads attached since then are after the others
+    Records.for_each([&operations, &i, &unreachable](ThreadRecord& other){
+        if(i < operations.size() && (operations[i] & 1) && other.Operations.load() == operations[i]){
+            unreachable = false;
+        }
+
+        ++i;
+    });
+
+    return unreachable;
 }
 
 template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
-bool HazardManager<Node, Threads, Size, Prefill>::isReferenced(Node* node){
-#ifdef DEBUG
-    for(unsigned int tid = 0; tid < Threads; ++tid){
-        for(unsigned int i = 0; i < Size; ++i){
-            if(Pointers.at(tid).at(i) == node){
-                return true;
-            }
+inline unsigned int HazardManager<Node, Threads, Size, Prefill>::keptNodes() const {
+    return std::max(HighWater / Records.capacity(), 2 * PoolBatch);
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+void HazardManager<Node, Threads, Size, Prefill>::reclaim(){
+    //The helper runs the reclamation of all the managers, most of them have nothing handed
+    if(!Waiting.exchange(false)){
+        return;
+    }
+
+    ThreadRecord& helper = *HelperRecord;
+
+    //The helper does not allocate, its free nodes can only go to the pool or be destroyed
+    if(HighWater && helper.FreeQueue.size() > keptNodes()){
+        share(helper, 0);
+
+        //The batches wait until the surplus put aside is destroyed, the next wake-up tries again
+        if(helper.FreeQueue.size() > keptNodes()){
+            Waiting.store(true);
+            return;
         }
     }
-#else
-    for(unsigned int tid = 0; tid < Threads; ++tid){
+
+    while(Handed.steal(helper.LocalQueue, 0)){
+        //Take all the batches at once, they are scanned together
+    }
+
+    //The nodes still referenced are scanned again with the next batches
+    scan(helper);
+    share(helper, 0);
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+bool HazardManager<Node, Threads, Size, Prefill>::isReferenced(Node* node){
+    bool referenced = false;
+
+    Records.for_each([node, &referenced](ThreadRecord& other){
         for(unsigned int i = 0; i < Size; ++i){
-            if(Pointers[tid][i] == node){
-                return true;
+            if(other.Pointers[i] == node){
+                referenced = true;
             }
         }
-    }
-#endif
+    });
 
-    return false;
+    return referenced;
 }
 
 template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
 void HazardManager<Node, Threads, Size, Prefill>::publish(Node* node, unsigned int i){
 #ifdef DEBUG
-    Pointers.at(thread_num).at(i) = node;
-#else
-    Pointers[thread_num][i] = node;
+    assert(i < Size);
 #endif
+
+    record(thread_num).Pointers[i] = node;
+
+    //The publication must be visible before the node is read again
+    light_fence();
 }
 
 template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
 void HazardManager<Node, Threads, Size, Prefill>::release(unsigned int i){
 #ifdef DEBUG
-    Pointers.at(thread_num).at(i) = nullptr;
-#else
-    Pointers[thread_num][i] = nullptr;
+    assert(i < Size);
 #endif
+
+    record(thread_num).Pointers[i] = nullptr;
 }
 
 template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
 void HazardManager<Node, Threads, Size, Prefill>::releaseAll(){
-#ifdef DEBUG
+    ThreadRecord& thread = record(thread_num);
+
     for(unsigned int i = 0; i < Size; ++i){
-        Pointers.at(thread_num).at(i) = nullptr;
+        thread.Pointers[i] = nullptr;
     }
-#else
-    for(unsigned int i = 0; i < Size; ++i){
-        Pointers[thread_num][i] = nullptr;
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+inline void HazardManager<Node, Threads, Size, Prefill>::enter(){
+    if(HighWater){
+        ThreadRecord& thread = record(thread_num);
+
+        if(thread.Depth++ == 0){
+            thread.Operations.store(thread.Operations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+            //The start of the operation must be visible before any node is read
+            light_fence();
+        }
+    }
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+inline void HazardManager<Node, Threads, Size, Prefill>::exit(){
+    if(HighWater){
+        ThreadRecord& thread = record(thread_num);
+
+        if(--thread.Depth == 0){
+            thread.Operations.store(thread.Operations.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
     }
-#endif
 }
 
+/*!
+ * Reclamation policy protecting each node with a hazard pointer. 
+ */
+struct HazardPointers {};
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+struct Reclaimer<HazardPointers, Node, Threads, Size, Prefill> {
+    typedef HazardManager<Node, Threads, Size, Prefill> type;
+};
+
 #endif
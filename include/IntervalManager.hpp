@@ -0,0 +1,470 @@
+#ifndef INTERVAL_MANAGER
+#define INTERVAL_MANAGER
+
+#include <cassert>
+#include <cstdlib>
+#include <new>
+#include <limits>
+#include <algorithm>
+#include <vector>
+#include <atomic>
+
+#include "Utils.hpp"
+#include "ThreadRegistry.hpp"
+#include "SlabArena.hpp"
+#include "Reclaimer.hpp"
+
+/*!
+ * A manager for Interval-Based Reclamation (two global eras).
+ * Each node is tagged with the era of its allocation and the era of its release. Instead of
+ * publishing each node it reads, a thread reserves an interval of eras: the era at the start
+ * of its operation and the last era seen when reading a node. A released node is reused once
+ * no reserved interval intersects its lifetime. A thread stalled in an operation only holds
+ * back the nodes allocated before its last read, so unlike epochs, the number of released
+ * nodes waiting stays bounded.
+ * publish() only reads the global era and updates the reservation of the thread when the
+ * era has changed, release() does nothing. Like HazardManager, it shares the surplus of free
+ * nodes of each thread through a pool per NUMA node and, above its high-water mark, destroys
+ * it once all the operations running when it was put aside have ended.
+ * \param Node The type of node to manage.
+ * \param Threads The number of records allocated at first, more threads can be attached.
+ * \param Size The number of references the structure would protect with hazard pointers, only used to scale the scans.
+ * \param Prefill The number of nodes to reserve in the arena of each thread.
+ */
+template<typename Node, unsigned int Threads, unsigned int Size = 2, unsigned int Prefill = 50>
+class IntervalManager {
+    public:
+        IntervalManager();
+        ~IntervalManager();
+
+        IntervalManager(const IntervalManager& rhs) = delete;
+        IntervalManager& operator=(const IntervalManager& rhs) = delete;
+
+        /*!
+         * Release the node. It is reused once no reserved interval contains its lifetime.
+         */
+        void releaseNode(Node* node);
+
+        /*!
+         * \brief Release the node by checking first if it is not already released.
+         * This method can be slow depending on the number of nodes already released.
+         * \param node The node to release.
+         */
+        void safe_release_node(Node* node);
+
+        /*!
+         * Set the high-water mark of the free nodes. Above it, the surplus of free nodes of a
+         * thread is destroyed, so that the slabs whose nodes are all destroyed are given back
+         * to the system. Defaults to default_high_water.
+         * \param nodes The number of free nodes to keep for all the threads, 0 to keep all of them.
+         */
+        void setHighWater(unsigned int nodes);
+
+        /*!
+         * Return the sum of the reclamation counters of all the threads. A scan is a comparison
+         * of the released nodes of a thread to the reserved intervals.
+         * The counters are read while the threads are running, so the snapshot is not atomic.
+         */
+        ReclamationStats stats();
+
+        /*!
+         * Indicates if the node has been allocated by a manager of this type.
+         * The node may already be free, or marked in its lowest bits, or null.
+         */
+        static bool carved(Node* node);
+
+        /*!
+         * Return a free node for the calling thread, tagged with the current era.
+         * \return A free node
+         */
+        Node* getFreeNode();
+
+        /*!
+         * Extend the reserved interval of the calling thread to the current era.
+         * Must be called after the reference to the node has been read.
+         * \param node Unused, the interval protects all the nodes read since the start of the operation.
+         * \param i Unused.
+         */
+        void publish(Node* node, unsigned int i);
+
+        /*!
+         * Does nothing, the node stays protected until the end of the operation.
+         */
+        void release(unsigned int i);
+
+        /*!
+         * Does nothing, the nodes stay protected until the end of the operation.
+         */
+        void releaseAll();
+
+        /*!
+         * Enter a critical section: reserve the current era for the calling thread.
+         * The critical sections can be nested, only the outermost one reserves the era.
+         */
+        void enter();
+
+        /*!
+         * Leave the critical section of the calling thread and clear its reservation.
+         */
+        void exit();
+
+    private:
+        /*!
+         * A node with the eras of its lifetime. The node is stored first so that
+         * a pointer to the node is also a pointer to the tagged node.
+         */
+        struct TaggedNode {
+            Node node;                  //Must be the first member
+            unsigned long birth;        //The era of the allocation
+            unsigned long retire;       //The era of the release
+
+            TaggedNode() : node(), birth(0), retire(0) {}
+        };
+
+        static TaggedNode* tagged(Node* node);
+
+        /*!
+         * The interval of eras reserved by a thread.
+         */
+        struct Reservation {
+            unsigned long lower;
+            unsigned long upper;
+        };
+
+        //The reservation of a thread outside of an operation
+        static const unsigned long NoEra = std::numeric_limits<unsigned long>::max();
+
+        /*!
+         * All the state of a single thread.
+         */
+        struct ThreadRecord {
+            std::atomic<unsigned long> Lower;           //The era at the start of the operation, NoEra outside of an operation
+            std::atomic<unsigned long> Upper;           //The last era seen by the operation
+            unsigned int Depth;                         //Number of nested critical sections
+            unsigned int Allocations;                   //Number of nodes allocated since the last era
+            unsigned int Reserved;                      //Number of released nodes still reserved after the last scan
+            NodeQueue<TaggedNode> RetiredQueue;
+            NodeQueue<TaggedNode> FreeQueue;
+            SlabArena<TaggedNode> Arena;
+            bool Prefilled;                             //The arena is prefilled by the thread itself, on its NUMA node
+            std::vector<Reservation> Snapshot;          //Kept to not allocate at each scan
+            ReclamationCounters Counters;
+
+            NodeQueue<TaggedNode> DoomedQueue;          //The surplus of free nodes waiting to be destroyed
+            unsigned long DoomedEra;                    //The era when the surplus was put aside
+
+            ThreadRecord(){
+                Lower.store(NoEra);
+                Upper.store(NoEra);
+                Depth = 0;
+                Allocations = 0;
+                Reserved = 0;
+                DoomedEra = 0;
+                Prefilled = false;
+            }
+        };
+
+        std::atomic<unsigned long> Era;
+
+        ThreadTable<ThreadRecord> Records;
+
+        /*!
+         * Number of nodes moved at once between the free queue of a thread and the pool.
+         */
+        static const unsigned int PoolBatch = 32;
+
+        NumaNodePool<TaggedNode> Pool;
+
+        unsigned int HighWater;
+
+        /*!
+         * Number of nodes a thread allocates before advancing the global era.
+         */
+        static const unsigned int EraFrequency = 64;
+
+        ThreadRecord& record(unsigned int tid);
+
+        /*!
+         * Number of released nodes a thread accumulates, in addition to the ones still reserved after
+         * its last scan, before comparing them to the reservations. The same as HazardManager, so that 
+         * both bound the released nodes the same way. The nodes released by a thread during its 
+         * operation are always reserved by the thread itself, they are not scanned again at each release. 
+         */
+        unsigned int scanThreshold() const;
+
+        /*!
+         * Move all the released nodes of the given thread whose lifetime does not intersect
+         * any reserved interval to its free queue.
+         */
+        void scan(ThreadRecord& thread);
+
+        /*!
+         * Give the free nodes of the given thread to the pool, except a batch for its own use.
+         * If the pool is full, put aside the nodes above the share of the thread of the high-water mark
+         * and destroy the nodes put aside previously if no thread can read them anymore.
+         */
+        void share(ThreadRecord& thread, unsigned int tid);
+
+        /* Verify the template parameters */
+        static_assert(Threads > 0, "The number of threads must be greater than 0");
+};
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+IntervalManager<Node, Threads, Size, Prefill>::IntervalManager() : Records(Threads), HighWater(default_high_water) {
+    Era.store(1);
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+IntervalManager<Node, Threads, Size, Prefill>::~IntervalManager(){
+    //All the nodes are destroyed with the arenas
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+inline typename IntervalManager<Node, Threads, Size, Prefill>::TaggedNode* IntervalManager<Node, Threads, Size, Prefill>::tagged(Node* node){
+    return reinterpret_cast<TaggedNode*>(node);
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+inline typename IntervalManager<Node, Threads, Size, Prefill>::ThreadRecord& IntervalManager<Node, Threads, Size, Prefill>::record(unsigned int tid){
+#ifdef DEBUG
+    assert(tid < thread_slots());
+#endif
+
+    return Records[tid];
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+inline unsigned int IntervalManager<Node, Threads, Size, Prefill>::scanThreshold() const {
+    return 2 * Records.capacity() * Size;
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+void IntervalManager<Node, Threads, Size, Prefill>::enter(){
+    ThreadRecord& thread = record(thread_num);
+
+    if(thread.Depth++ == 0){
+        unsigned long era = Era.load();
+
+        //Sequentially consistent, the reservation must be visible before any node is read
+        thread.Upper.store(era);
+        thread.Lower.store(era);
+    }
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+void IntervalManager<Node, Threads, Size, Prefill>::exit(){
+    ThreadRecord& thread = record(thread_num);
+
+    if(--thread.Depth == 0){
+        thread.Lower.store(NoEra, std::memory_order_release);
+        thread.Upper.store(NoEra, std::memory_order_release);
+    }
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+inline void IntervalManager<Node, Threads, Size, Prefill>::publish(Node* /*node*/, unsigned int /*i*/){
+    ThreadRecord& thread = record(thread_num);
+
+    //The node was allocated before its reference was read, so its birth is covered by the current era
+    unsigned long era = Era.load();
+
+    if(thread.Upper.load(std::memory_order_relaxed) != era){
+        thread.Upper.store(era);
+    }
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+inline void IntervalManager<Node, Threads, Size, Prefill>::release(unsigned int /*i*/){
+    //Nothing to do
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+inline void IntervalManager<Node, Threads, Size, Prefill>::releaseAll(){
+    //Nothing to do
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+void IntervalManager<Node, Threads, Size, Prefill>::releaseNode(Node* node){
+    //If the node is null, we have nothing to do
+    if(node){
+        int tid = thread_num;
+        ThreadRecord& thread = record(tid);
+
+        TaggedNode* released = tagged(node);
+        released->retire = Era.load();
+
+        thread.RetiredQueue.push_back(released);
+        thread.Counters.retire(thread.RetiredQueue.size());
+
+        //Scan here and not when allocating, a thread that mostly removes would never free its nodes
+        if(thread.RetiredQueue.size() >= thread.Reserved + scanThreshold()){
+            scan(thread);
+            share(thread, tid);
+        }
+    }
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+void IntervalManager<Node, Threads, Size, Prefill>::safe_release_node(Node* node){
+    if(node){
+        ThreadRecord& thread = record(thread_num);
+
+        if(thread.RetiredQueue.contains(tagged(node))){
+            return;
+        }
+
+        releaseNode(node);
+    }
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+void IntervalManager<Node, Threads, Size, Prefill>::setHighWater(unsigned int nodes){
+    HighWater = nodes;
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+bool IntervalManager<Node, Threads, Size, Prefill>::carved(Node* node){
+    return SlabArena<TaggedNode>::carved(tagged(node));
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+ReclamationStats IntervalManager<Node, Threads, Size, Prefill>::stats(){
+    ReclamationStats stats;
+
+    Records.for_each([&stats](ThreadRecord& thread){
+        thread.Counters.snapshot(stats);
+    });
+
+    return stats;
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+Node* IntervalManager<Node, Threads, Size, Prefill>::getFreeNode(){
+    int tid = thread_num;
+    ThreadRecord& thread = record(tid);
+
+    //The records are constructed by the thread creating the manager, the first slab must be mapped by the owner
+    if(!thread.Prefilled){
+        thread.Arena.reserve(Prefill);
+        thread.Prefilled = true;
+    }
+
+    //Advance the era from time to time, the nodes allocated after a stalled thread has read its last node are not held back by it
+    if(++thread.Allocations == EraFrequency){
+        thread.Allocations = 0;
+        Era.fetch_add(1);
+    }
+
+    TaggedNode* node;
+
+    //First, try to get a free node from the free queue, then, take back nodes given by the other threads
+    if(!thread.FreeQueue.empty() || Pool.steal(thread.FreeQueue, tid)){
+        node = thread.FreeQueue.pop_front();
+    } else {
+        //There was no way to get a free node, carve a new one from the arena
+        thread.Counters.allocate();
+
+        node = thread.Arena.allocate();
+    }
+
+    node->birth = Era.load();
+
+    return &node->node;
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+void IntervalManager<Node, Threads, Size, Prefill>::scan(ThreadRecord& thread){
+    NodeQueue<TaggedNode>& retired_queue = thread.RetiredQueue;
+
+    unsigned int waiting = retired_queue.size();
+
+    //Advance the era, the operations started from now on do not reserve the nodes already released
+    Era.fetch_add(1);
+
+    //Take a snapshot of the reservations of the threads in an operation, each one is read only once
+    std::vector<Reservation>& snapshot = thread.Snapshot;
+    snapshot.clear();
+
+    Records.for_each([&snapshot](ThreadRecord& other){
+        unsigned long lower = other.Lower.load();
+
+        if(lower != NoEra){
+            snapshot.push_back({lower, other.Upper.load()});
+        }
+    });
+
+    for(unsigned int i = retired_queue.size(); i > 0; --i){
+        TaggedNode* node = retired_queue.pop_front();
+        bool reserved = false;
+
+        for(const Reservation& reservation : snapshot){
+            if(reservation.lower <= node->retire && node->birth <= reservation.upper){
+                reserved = true;
+                break;
+            }
+        }
+
+        if(!reserved){
+            thread.FreeQueue.push_back(node);
+        } else {
+            retired_queue.push_back(node);
+        }
+    }
+
+    thread.Reserved = retired_queue.size();
+    thread.Counters.scan(waiting - retired_queue.size());
+}
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+void IntervalManager<Node, Threads, Size, Prefill>::share(ThreadRecord& thread, unsigned int tid){
+    NodeQueue<TaggedNode>& free_queue = thread.FreeQueue;
+
+    while(free_queue.size() >= 2 * PoolBatch && Pool.push(free_queue, PoolBatch, tid)){
+        //Continue until the pool is full
+    }
+
+    if(HighWater){
+        NodeQueue<TaggedNode>& doomed_queue = thread.DoomedQueue;
+
+        if(!doomed_queue.empty()){
+            unsigned long doomed_era = thread.DoomedEra;
+            bool reachable = false;
+
+            //The operations started after the surplus was put aside have a greater lower era
+            Records.for_each([doomed_era, &reachable](ThreadRecord& other){
+                if(other.Lower.load() <= doomed_era){
+                    reachable = true;
+                }
+            });
+
+            if(!reachable){
+                while(!doomed_queue.empty()){
+                    SlabArena<TaggedNode>::destroy(doomed_queue.pop_front());
+                }
+            }
+        }
+
+        unsigned int keep = std::max(HighWater / Records.capacity(), 2 * PoolBatch);
+
+        //Only one batch is waiting at a time, the next surplus stays free until it is destroyed
+        if(doomed_queue.empty() && free_queue.size() > keep){
+            while(free_queue.size() > keep){
+                doomed_queue.push_back(free_queue.pop_front());
+            }
+
+            thread.DoomedEra = Era.fetch_add(1);
+        }
+    }
+}
+
+/*!
+ * Reclamation policy protecting the nodes read by an operation with an interval of eras.
+ */
+struct Intervals {};
+
+template<typename Node, unsigned int Threads, unsigned int Size, unsigned int Prefill>
+struct Reclaimer<Intervals, Node, Threads, Size, Prefill> {
+    typedef IntervalManager<Node, Threads, Size, Prefill> type;
+};
+
+#endif
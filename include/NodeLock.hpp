@@ -0,0 +1,98 @@
+#ifndef NODE_LOCK
+#define NODE_LOCK
+
+#include <atomic>
+
+/*!
+ * Park the calling thread as long as the word holds the given value (FUTEX_WAIT).
+ */
+void futex_wait(std::atomic<int>* word, int value);
+
+/*!
+ * Wake all the threads parked on the word (FUTEX_WAKE).
+ */
+void futex_wake_all(std::atomic<int>* word);
+
+/*!
+ * A lock of four bytes for the nodes of the trees, small enough to be stored in the padding
+ * of a node, where a std::mutex takes 40 bytes. The lock spins for a while, then parks the thread
+ * on its own word with a futex. The word is 0 when free, 1 when locked and 2 when locked
+ * with parked threads, so the owner only wakes them up when there are some.
+ * It can be used with std::lock_guard.
+ */
+class NodeLock {
+    public:
+        NodeLock() : state(0) {}
+
+        void lock();
+        bool try_lock();
+        void unlock();
+
+        /*!
+         * Wait until the lock is free, without taking it. The thread is parked on the word of
+         * the lock like the threads waiting to take it.
+         */
+        void waitUnlocked();
+
+    private:
+        static const int SpinCount = 100;
+
+        void lockSlow();
+
+        std::atomic<int> state;
+};
+
+inline bool NodeLock::try_lock(){
+    int expected = 0;
+    return state.compare_exchange_strong(expected, 1, std::memory_order_acquire);
+}
+
+inline void NodeLock::lock(){
+    if(!try_lock()){
+        lockSlow();
+    }
+}
+
+inline void NodeLock::lockSlow(){
+    for(int i = 0; i < SpinCount; ++i){
+        if(state.load(std::memory_order_relaxed) == 0 && try_lock()){
+            return;
+        }
+    }
+
+    //Announce the parked threads, the lock is then taken in the contended state
+    while(state.exchange(2, std::memory_order_acquire) != 0){
+        futex_wait(&state, 2);
+    }
+}
+
+inline void NodeLock::unlock(){
+    if(state.exchange(0, std::memory_order_release) == 2){
+        //The threads waiting for the lock to be free are woken up as well, not only one of the lockers
+        futex_wake_all(&state);
+    }
+}
+
+inline void NodeLock::waitUnlocked(){
+    for(int i = 0; i < SpinCount; ++i){
+        if(state.load(std::memory_order_acquire) == 0){
+            return;
+        }
+    }
+
+    while(true){
+        int current = state.load(std::memory_order_acquire);
+
+        if(current == 0){
+            return;
+        }
+
+        if(current == 1 && !state.compare_exchange_weak(current, 2, std::memory_order_relaxed)){
+            continue;
+        }
+
+        futex_wait(&state, 2);
+    }
+}
+
+#endif
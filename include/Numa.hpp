@@ -0,0 +1,42 @@
+#ifndef NUMA_NODES
+#define NUMA_NODES
+
+#include <cstddef>
+
+//NUMA node of the calling thread, set by thread_attach() and pin_thread()
+//Note: __thread is GCC specific
+extern __thread unsigned int thread_node;
+
+/*!
+ * Return the number of NUMA nodes of the machine, 1 if the information is not available.
+ */
+unsigned int numa_nodes();
+
+/*!
+ * Return the NUMA node of the given CPU, 0 if the information is not available.
+ * \param cpu The CPU to locate.
+ */
+unsigned int numa_node_of_cpu(unsigned int cpu);
+
+/*!
+ * Return the NUMA node on which the calling thread is running right now.
+ */
+unsigned int current_numa_node();
+
+/*!
+ * Pin the calling thread on the given CPU and update thread_node.
+ * \param cpu The CPU to run on.
+ * \return true if the thread has been pinned, otherwise false.
+ */
+bool pin_thread(unsigned int cpu);
+
+/*!
+ * Ask the system to back the given memory with pages of the given NUMA node, if possible.
+ * Must be called before the memory is touched. Does nothing on a single-node machine.
+ * \param memory The beginning of the memory, aligned on a page.
+ * \param bytes The size of the memory.
+ * \param node The NUMA node to use.
+ */
+void bind_to_node(void* memory, std::size_t bytes, unsigned int node);
+
+#endif
@@ -0,0 +1,315 @@
+#ifndef RECLAIMER
+#define RECLAIMER
+
+#include <atomic>
+#include <ostream>
+#include <algorithm>
+
+/*!
+ * Give the manager used by a structure to reclaim its nodes. 
+ * This is specialized by each reclamation policy with a type member. 
+ * \param Policy The reclamation policy (HazardPointers, Epochs or Intervals). 
+ * \param Node The type of node to manage. 
+ * \param Threads The number of threads expected, more threads can be attached. 
+ * \param Size The number of references protected at once by each thread. 
+ * \param Prefill The number of nodes to reserve for each thread.
+ */
+template<typename Policy, typename Node, unsigned int Threads, unsigned int Size = 2, unsigned int Prefill = 50>
+struct Reclaimer;
+
+/*!
+ * Keep the calling thread in a critical section of the given manager as long as the object lives. 
+ * Every operation of the structures is done in a critical section of each of their managers. 
+ * \param Manager The type of the manager. 
+ */
+template<typename Manager>
+class CriticalSection {
+    public:
+        explicit CriticalSection(Manager& manager) : manager(manager) {
+            manager.enter();
+        }
+
+        ~CriticalSection(){
+            manager.exit();
+        }
+
+        CriticalSection(const CriticalSection& rhs) = delete;
+        CriticalSection& operator=(const CriticalSection& rhs) = delete;
+
+    private:
+        Manager& manager;
+};
+
+/*!
+ * A snapshot of the reclamation counters of one or several managers. 
+ */
+struct ReclamationStats {
+    unsigned long retired;      //Nodes released by the structure
+    unsigned long scans;        //Attempts to make released nodes free (scans of the hazard pointers or collections of the epochs)
+    unsigned long reclaimed;    //Released nodes made free by the scans
+    unsigned long allocated;    //Nodes carved from the arenas because no free node was available
+    unsigned long peak_local;   //Largest number of released nodes waiting in a thread
+
+    ReclamationStats() : retired(0), scans(0), reclaimed(0), allocated(0), peak_local(0) {}
+
+    /*!
+     * Add the counters of other managers, the peaks are not added but the largest one is kept. 
+     */
+    ReclamationStats& operator+=(const ReclamationStats& rhs){
+        retired += rhs.retired;
+        scans += rhs.scans;
+        reclaimed += rhs.reclaimed;
+        allocated += rhs.allocated;
+        peak_local = std::max(peak_local, rhs.peak_local);
+
+        return *this;
+    }
+
+    double reclaimed_per_scan() const {
+        return scans ? static_cast<double>(reclaimed) / scans : 0.0;
+    }
+};
+
+inline std::ostream& operator<<(std::ostream& stream, const ReclamationStats& stats){
+    return stream << stats.retired << " retired, " << stats.scans << " scans, " << stats.reclaimed_per_scan() << " reclaimed/scan, " 
+        << stats.allocated << " allocated, " << stats.peak_local << " peak local";
+}
+
+/*!
+ * Add a value to a counter only written by the calling thread. 
+ */
+inline void add_to_counter(std::atomic<unsigned long>& counter, unsigned long value){
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+/*!
+ * The reclamation counters of a thread, kept in the record of the thread in its manager. 
+ * They are only written by their thread, so they are incremented without atomic instructions, 
+ * atomics being only used to read them from any thread. 
+ */
+struct ReclamationCounters {
+    std::atomic<unsigned long> retired;
+    std::atomic<unsigned long> scans;
+    std::atomic<unsigned long> reclaimed;
+    std::atomic<unsigned long> allocated;
+    std::atomic<unsigned long> peak_local;
+
+    ReclamationCounters(){
+        retired.store(0);
+        scans.store(0);
+        reclaimed.store(0);
+        allocated.store(0);
+        peak_local.store(0);
+    }
+
+    /*!
+     * Count a released node. 
+     * \param waiting The number of released nodes of the thread not yet free. 
+     */
+    void retire(unsigned long waiting){
+        add_to_counter(retired, 1);
+
+        if(waiting > peak_local.load(std::memory_order_relaxed)){
+            peak_local.store(waiting, std::memory_order_relaxed);
+        }
+    }
+
+    /*!
+     * Count a scan. 
+     * \param freed The number of released nodes made free by the scan. 
+     */
+    void scan(unsigned long freed){
+        add_to_counter(scans, 1);
+        add_to_counter(reclaimed, freed);
+    }
+
+    /*!
+     * Count released nodes made free without a scan. 
+     * \param freed The number of released nodes made free. 
+     */
+    void reclaim(unsigned long freed){
+        add_to_counter(reclaimed, freed);
+    }
+
+    void allocate(){
+        add_to_counter(allocated, 1);
+    }
+
+    /*!
+     * Add the counters of the thread to the given snapshot. 
+     */
+    void snapshot(ReclamationStats& stats) const {
+        ReclamationStats thread;
+
+        thread.retired = retired.load(std::memory_order_relaxed);
+        thread.scans = scans.load(std::memory_order_relaxed);
+        thread.reclaimed = reclaimed.load(std::memory_order_relaxed);
+        thread.allocated = allocated.load(std::memory_order_relaxed);
+        thread.peak_local = peak_local.load(std::memory_order_relaxed);
+
+        stats += thread;
+    }
+};
+
+/*!
+ * Reclaim nodes of different sizes with a manager for each size class. 
+ * The nodes of a structure are made of a fixed part followed by a variable number of levels. 
+ * A node is carved from the smallest class that holds its levels and always stays in its class, 
+ * so the memory of a node is never read with the height of another class. The class of a node 
+ * is found from the header of its slab, that stays valid when the node is free, so a reference 
+ * read without protection is still published to the right manager. 
+ * The nodes of all the classes are protected together: the critical sections and the releases 
+ * go to all the managers, the publications only to the manager of the node. 
+ * \param Policy The reclamation policy (HazardPointers, Epochs or Intervals). 
+ * \param Towers Describe the nodes: node_type, the type seen by the structure, and tower<Height>, 
+ * a node_type followed by room for Height levels. 
+ * \param Threads The number of threads expected, more threads can be attached. 
+ * \param Size The number of references protected at once by each thread. 
+ * \param Heights The number of levels of each class, in increasing order. 
+ */
+template<typename Policy, typename Towers, unsigned int Threads, unsigned int Size, unsigned int... Heights>
+class SizeClasses;
+
+template<typename Policy, typename Towers, unsigned int Threads, unsigned int Size, unsigned int Height>
+class SizeClasses<Policy, Towers, Threads, Size, Height> {
+    public:
+        typedef typename Towers::node_type Node;
+
+        static const unsigned int Smallest = Height;
+
+        SizeClasses(){}
+
+        SizeClasses(const SizeClasses& rhs) = delete;
+        SizeClasses& operator=(const SizeClasses& rhs) = delete;
+
+        /*!
+         * Return a free node of the calling thread with room for at least the given number of levels. 
+         */
+        Node* getFreeNode(unsigned int /*height*/){
+            return &manager.getFreeNode()->node;
+        }
+
+        void releaseNode(Node* node){
+            manager.releaseNode(tower(node));
+        }
+
+        void publish(Node* node, unsigned int i){
+            manager.publish(tower(node), i);
+        }
+
+        void release(unsigned int i){
+            manager.release(i);
+        }
+
+        void releaseAll(){
+            manager.releaseAll();
+        }
+
+        void enter(){
+            manager.enter();
+        }
+
+        void exit(){
+            manager.exit();
+        }
+
+        void setHighWater(unsigned int nodes){
+            manager.setHighWater(nodes);
+        }
+
+        ReclamationStats stats(){
+            return manager.stats();
+        }
+
+    protected:
+        //The node, maybe marked or null, has been allocated by this class
+        static bool carved(Node* node){
+            return decltype(manager)::carved(tower(node));
+        }
+
+        typedef typename Towers::template tower<Height> Tower;
+
+        //The node is the first member of its tower
+        static Tower* tower(Node* node){
+            return reinterpret_cast<Tower*>(node);
+        }
+
+        typename Reclaimer<Policy, Tower, Threads, Size>::type manager;
+};
+
+template<typename Policy, typename Towers, unsigned int Threads, unsigned int Size, unsigned int Height, unsigned int... Heights>
+class SizeClasses<Policy, Towers, Threads, Size, Height, Heights...> : private SizeClasses<Policy, Towers, Threads, Size, Height> {
+    typedef SizeClasses<Policy, Towers, Threads, Size, Height> Class;
+
+    public:
+        typedef typename Towers::node_type Node;
+
+        static const unsigned int Smallest = Height;
+
+        SizeClasses(){}
+
+        SizeClasses(const SizeClasses& rhs) = delete;
+        SizeClasses& operator=(const SizeClasses& rhs) = delete;
+
+        /*!
+         * Return a free node of the calling thread with room for at least the given number of levels. 
+         */
+        Node* getFreeNode(unsigned int height){
+            return height <= Height ? Class::getFreeNode(height) : larger.getFreeNode(height);
+        }
+
+        void releaseNode(Node* node){
+            if(Class::carved(node)){
+                Class::releaseNode(node);
+            } else {
+                larger.releaseNode(node);
+            }
+        }
+
+        void publish(Node* node, unsigned int i){
+            if(Class::carved(node)){
+                Class::publish(node, i);
+            } else {
+                larger.publish(node, i);
+            }
+        }
+
+        void release(unsigned int i){
+            Class::release(i);
+            larger.release(i);
+        }
+
+        void releaseAll(){
+            Class::releaseAll();
+            larger.releaseAll();
+        }
+
+        void enter(){
+            Class::enter();
+            larger.enter();
+        }
+
+        void exit(){
+            larger.exit();
+            Class::exit();
+        }
+
+        void setHighWater(unsigned int nodes){
+            Class::setHighWater(nodes);
+            larger.setHighWater(nodes);
+        }
+
+        ReclamationStats stats(){
+            ReclamationStats stats = Class::stats();
+            stats += larger.stats();
+
+            return stats;
+        }
+
+    private:
+        SizeClasses<Policy, Towers, Threads, Size, Heights...> larger;
+
+        static_assert(Height < SizeClasses<Policy, Towers, Threads, Size, Heights...>::Smallest, "The classes must be in increasing order");
+};
+
+#endif
@@ -0,0 +1,549 @@
+#ifndef SLAB_ARENA
+#define SLAB_ARENA
+
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <algorithm>
+#include <atomic>
+
+#include "Numa.hpp"
+
+//Number of free nodes kept by each new manager before destroying the surplus, 0 to keep them all
+extern unsigned int default_high_water;
+
+//Indicates that the arenas created from now on carve their slabs from 2MB pages
+extern bool huge_slabs;
+
+//Number of bytes of slabs currently backed by memory
+extern std::atomic<std::size_t> slab_bytes;
+
+/*!
+ * Map a new slab aligned on its size.
+ * \param bytes The size of the slab, a power of two multiple of the page size.
+ * \param huge Indicates that the slab is carved from a huge page (MAP_HUGETLB or, if no huge page is
+ * reserved, a transparent huge page). Huge pages are never given back to the system, their slabs are reused.
+ * \return The slab, filled with zeroes.
+ */
+void* map_slab(std::size_t bytes, bool huge);
+
+/*!
+ * Give a slab mapped with map_slab() back to the system, or to the slabs of the huge pages.
+ */
+void unmap_slab(void* slab, std::size_t bytes, bool huge);
+
+/*!
+ * Give the pages fully contained in the given memory back to the system. The memory stays
+ * mapped and is filled with zeroes when touched again.
+ */
+void release_pages(void* memory, std::size_t bytes);
+
+/*!
+ * Account for the pages released with release_pages() that are going to be touched again.
+ */
+void reuse_pages(void* memory, std::size_t bytes);
+
+/*!
+ * A cell of a slab. The node is stored first so that a pointer to the node
+ * is also a pointer to its cell. The link is used to chain the node in the
+ * intrusive queues without touching the node itself.
+ * \param Node The type of node stored in the cell.
+ */
+template<typename Node>
+struct SlabCell {
+    Node node;              //Must be the first member
+    SlabCell<Node>* next;   //Intrusive link
+};
+
+template<typename Node>
+inline SlabCell<Node>* cell_of(Node* node){
+    return reinterpret_cast<SlabCell<Node>*>(node);
+}
+
+/*!
+ * An intrusive FIFO queue of nodes allocated from a SlabArena.
+ * Pushing and popping nodes never allocates memory.
+ * \param Node The type of node to hold.
+ */
+template<typename Node>
+class NodeQueue {
+    public:
+        NodeQueue() : head(nullptr), tail(nullptr), length(0) {}
+
+        NodeQueue(const NodeQueue& rhs) = delete;
+        NodeQueue& operator=(const NodeQueue& rhs) = delete;
+
+        bool empty() const {
+            return !head;
+        }
+
+        unsigned int size() const {
+            return length;
+        }
+
+        /*!
+         * Add the node at the end of the queue.
+         * \param node The node to add.
+         */
+        void push_back(Node* node){
+            SlabCell<Node>* cell = cell_of(node);
+            cell->next = nullptr;
+
+            if(tail){
+                tail->next = cell;
+            } else {
+                head = cell;
+            }
+
+            tail = cell;
+            ++length;
+        }
+
+        /*!
+         * Remove the first node of the queue. The queue must not be empty.
+         * \return The first node of the queue.
+         */
+        Node* pop_front(){
+            SlabCell<Node>* cell = head;
+
+            head = cell->next;
+            if(!head){
+                tail = nullptr;
+            }
+
+            --length;
+
+            return &cell->node;
+        }
+
+        /*!
+         * Move all the nodes of the given queue at the end of this queue. 
+         * \param rhs The queue to empty into this one. 
+         */
+        void append(NodeQueue& rhs){
+            if(rhs.head){
+                if(tail){
+                    tail->next = rhs.head;
+                } else {
+                    head = rhs.head;
+                }
+
+                tail = rhs.tail;
+                length += rhs.length;
+
+                rhs.head = rhs.tail = nullptr;
+                rhs.length = 0;
+            }
+        }
+
+        /*!
+         * Detach the first nodes of the queue. 
+         * \param count The number of nodes to detach, at most the size of the queue. 
+         * \return The first detached cell, the chain ending with a null link. 
+         */
+        SlabCell<Node>* take(unsigned int count){
+            SlabCell<Node>* first = head;
+            SlabCell<Node>* last = head;
+
+            for(unsigned int i = 1; i < count; ++i){
+                last = last->next;
+            }
+
+            head = last->next;
+            if(!head){
+                tail = nullptr;
+            }
+
+            last->next = nullptr;
+            length -= count;
+
+            return first;
+        }
+
+        /*!
+         * Add a chain of cells detached with take() at the end of the queue. 
+         * \param chain The first cell of the chain. 
+         */
+        void give(SlabCell<Node>* chain){
+            SlabCell<Node>* last = chain;
+            unsigned int count = 1;
+
+            while(last->next){
+                last = last->next;
+                ++count;
+            }
+
+            if(tail){
+                tail->next = chain;
+            } else {
+                head = chain;
+            }
+
+            tail = last;
+            length += count;
+        }
+
+        /*!
+         * Indicates if the given node is in the queue. This is linear in the size of the queue.
+         * \param node The node to search.
+         * \return true if the node is in the queue, otherwise false.
+         */
+        bool contains(Node* node) const {
+            for(SlabCell<Node>* cell = head; cell; cell = cell->next){
+                if(&cell->node == node){
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+    private:
+        SlabCell<Node>* head;
+        SlabCell<Node>* tail;
+        unsigned int length;
+};
+
+/*!
+ * A bounded pool of batches of free nodes shared by all the threads. 
+ * A thread with too many free nodes gives some of them to the pool and a thread 
+ * without free nodes takes them back, instead of carving new ones. 
+ * Each batch is a chain of cells held in a slot, so a batch is taken at once 
+ * with a single exchange. 
+ * \param Node The type of node to hold. 
+ * \param Slots The maximum number of batches in the pool. 
+ */
+template<typename Node, unsigned int Slots = 64>
+class NodePool {
+    public:
+        NodePool(){
+            for(unsigned int i = 0; i < Slots; ++i){
+                Batches[i].store(nullptr);
+            }
+        }
+
+        NodePool(const NodePool& rhs) = delete;
+        NodePool& operator=(const NodePool& rhs) = delete;
+
+        /*!
+         * Move a batch of nodes from the queue to the pool, if the pool is not full. 
+         * \param queue The queue to take the nodes from. 
+         * \param count The number of nodes of the batch, at most the size of the queue. 
+         * \param hint The first slot to try, to spread the threads over the slots. 
+         * \return true if the batch has been moved, otherwise false. 
+         */
+        bool push(NodeQueue<Node>& queue, unsigned int count, unsigned int hint){
+            SlabCell<Node>* batch = queue.take(count);
+
+            for(unsigned int i = 0; i < Slots; ++i){
+                std::atomic<SlabCell<Node>*>& slot = Batches[(hint + i) % Slots];
+                SlabCell<Node>* expected = nullptr;
+
+                if(!slot.load(std::memory_order_relaxed) && slot.compare_exchange_strong(expected, batch)){
+                    return true;
+                }
+            }
+
+            //The pool is full, keep the nodes
+            queue.give(batch);
+
+            return false;
+        }
+
+        /*!
+         * Move a batch of nodes from the pool to the queue. 
+         * \param queue The queue to fill. 
+         * \param hint The first slot to try. 
+         * \return true if a batch has been moved, otherwise false. 
+         */
+        bool steal(NodeQueue<Node>& queue, unsigned int hint){
+            for(unsigned int i = 0; i < Slots; ++i){
+                std::atomic<SlabCell<Node>*>& slot = Batches[(hint + i) % Slots];
+
+                if(slot.load(std::memory_order_relaxed)){
+                    SlabCell<Node>* batch = slot.exchange(nullptr);
+
+                    if(batch){
+                        queue.give(batch);
+
+                        return true;
+                    }
+                }
+            }
+
+            return false;
+        }
+
+    private:
+        std::atomic<SlabCell<Node>*> Batches[Slots];
+};
+
+/*!
+ * A NodePool for each NUMA node. A thread gives its free nodes to the pool of its node and 
+ * takes them back from the pool of its node first, so that the nodes stay close to the threads 
+ * that carved them. The pools of the other nodes are only used when its own pool is empty. 
+ * \param Node The type of node to hold. 
+ */
+template<typename Node>
+class NumaNodePool {
+    public:
+        NumaNodePool() : Count(numa_nodes()), Pools(new NodePool<Node>[Count]) {}
+
+        ~NumaNodePool(){
+            delete[] Pools;
+        }
+
+        NumaNodePool(const NumaNodePool& rhs) = delete;
+        NumaNodePool& operator=(const NumaNodePool& rhs) = delete;
+
+        /*!
+         * Move a batch of nodes from the queue to the pool of the node of the calling thread, if it is not full. 
+         * \see NodePool::push
+         */
+        bool push(NodeQueue<Node>& queue, unsigned int count, unsigned int hint){
+            return Pools[thread_node % Count].push(queue, count, hint);
+        }
+
+        /*!
+         * Move a batch of nodes from the pool of the node of the calling thread, or from the pool of the 
+         * closest node in order, to the queue. 
+         * \see NodePool::steal
+         */
+        bool steal(NodeQueue<Node>& queue, unsigned int hint){
+            for(unsigned int i = 0; i < Count; ++i){
+                if(Pools[(thread_node + i) % Count].steal(queue, hint)){
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+    private:
+        const unsigned int Count;
+        NodePool<Node>* Pools;
+};
+
+/*!
+ * Return the smallest power of two of at least minimum bytes, starting from a page.
+ */
+constexpr std::size_t slab_size(std::size_t minimum, std::size_t bytes = 4096){
+    return bytes >= minimum ? bytes : slab_size(minimum, 2 * bytes);
+}
+
+/*!
+ * A per-thread arena of nodes. Nodes are carved one by one from slabs of SlabBytes bytes.
+ * Each slab is aligned on its size, so the slab of a node is found by masking its address.
+ * A node obtained from the arena is recycled through NodeQueue without going back to the
+ * system, unless it is destroyed with destroy(). Once all the nodes of a slab are destroyed,
+ * the pages of the slab are given back to the system and the slab is carved again by its arena.
+ * If huge_slabs is set when the arena is created, the slabs are carved from 2MB pages to save
+ * TLB entries, and their pages are never given back, so that the huge pages are not split.
+ * \param Node The type of node to allocate.
+ * \param SlabBytes The minimal size of a slab, rounded up to a power of two.
+ */
+template<typename Node, std::size_t SlabBytes = 64 * 1024>
+class SlabArena {
+    public:
+        SlabArena() : slabs(nullptr), current(nullptr), reusable(nullptr), released(nullptr), huge(huge_slabs) {}
+        ~SlabArena();
+
+        SlabArena(const SlabArena& rhs) = delete;
+        SlabArena& operator=(const SlabArena& rhs) = delete;
+
+        /*!
+         * Make sure that at least capacity nodes (at most a slab) can be carved without mapping memory.
+         * \param capacity The number of nodes to reserve.
+         */
+        void reserve(unsigned int capacity);
+
+        /*!
+         * Carve a new node from the current slab. When the current slab is exhausted, a slab
+         * whose pages have been released is carved again, otherwise a new slab is mapped.
+         * \return A newly constructed node.
+         */
+        Node* allocate();
+
+        /*!
+         * Destroy a free node for good. The node must not be in any queue and must not be
+         * referenced anymore. Can be called by any thread, not only the owner of the arena.
+         * \param node The node to destroy.
+         */
+        static void destroy(Node* node);
+
+        /*!
+         * Indicates if the node has been carved by an arena of this type. Only the header of the slab
+         * of the node is read and its page is never given back, so the node may already be destroyed.
+         * \param node A node carved by any arena whose slabs have the same size, it can be marked in its
+         * lowest bits, or null.
+         * \return true if the slab of the node belongs to an arena of this type, false otherwise.
+         */
+        static bool carved(Node* node);
+
+    private:
+        struct Slab {
+            char* kind;                     //The type of the arena, same place for all the types
+            Slab* next;                     //The previously mapped slab of the arena
+            Slab* next_released;            //Link in the released slabs of the arena
+            SlabArena* arena;               //The owner of the slab
+            unsigned int used;              //Number of cells already carved
+            std::atomic<unsigned int> dead; //Number of cells destroyed
+        };
+
+        static const std::size_t Bytes = slab_size(SlabBytes);
+        static const std::size_t Offset = (sizeof(Slab) + alignof(SlabCell<Node>) - 1) / alignof(SlabCell<Node>) * alignof(SlabCell<Node>);
+        static const unsigned int Capacity = (Bytes - Offset) / sizeof(SlabCell<Node>);
+
+        Slab* slabs;                        //All the slabs mapped by the arena
+        Slab* current;                      //The slab being carved
+        Slab* reusable;                     //Released slabs taken back by the owner
+        std::atomic<Slab*> released;        //Slabs released by any thread
+        const bool huge;                    //The slabs are carved from huge pages
+
+        //Its address identifies the type of the arena in the slabs
+        static char Kind;
+
+        static Slab* slab_of(Node* node);
+        static SlabCell<Node>* cells(Slab* slab);
+
+        //Marks the link of the destroyed cells
+        static SlabCell<Node>* dead_cell();
+
+        Slab* next_slab();
+
+        static_assert(Capacity >= 16, "The slabs must contain at least 16 nodes");
+};
+
+template<typename Node, std::size_t SlabBytes>
+char SlabArena<Node, SlabBytes>::Kind;
+
+template<typename Node, std::size_t SlabBytes>
+SlabArena<Node, SlabBytes>::~SlabArena(){
+    while(slabs){
+        Slab* slab = slabs;
+        slabs = slab->next;
+
+        //The pages of a fully destroyed slab have been released, they must not be read
+        if(slab->dead.load() == Capacity){
+            if(!huge){
+                reuse_pages(cells(slab), Bytes - Offset);
+            }
+        } else if(slab->dead.load() != slab->used){
+            for(unsigned int i = 0; i < slab->used; ++i){
+                if(cells(slab)[i].next != dead_cell()){
+                    cells(slab)[i].node.~Node();
+                }
+            }
+        }
+
+        slab->~Slab();
+        unmap_slab(slab, Bytes, huge);
+    }
+}
+
+template<typename Node, std::size_t SlabBytes>
+inline typename SlabArena<Node, SlabBytes>::Slab* SlabArena<Node, SlabBytes>::slab_of(Node* node){
+    return reinterpret_cast<Slab*>(reinterpret_cast<std::uintptr_t>(node) & ~(Bytes - 1));
+}
+
+template<typename Node, std::size_t SlabBytes>
+inline SlabCell<Node>* SlabArena<Node, SlabBytes>::cells(Slab* slab){
+    return reinterpret_cast<SlabCell<Node>*>(reinterpret_cast<char*>(slab) + Offset);
+}
+
+template<typename Node, std::size_t SlabBytes>
+inline SlabCell<Node>* SlabArena<Node, SlabBytes>::dead_cell(){
+    return reinterpret_cast<SlabCell<Node>*>(1);
+}
+
+template<typename Node, std::size_t SlabBytes>
+typename SlabArena<Node, SlabBytes>::Slab* SlabArena<Node, SlabBytes>::next_slab(){
+    //First, carve again the slabs released by the threads
+    if(!reusable){
+        reusable = released.exchange(nullptr);
+    }
+
+    if(reusable){
+        Slab* slab = reusable;
+        reusable = slab->next_released;
+
+        slab->used = 0;
+        slab->dead.store(0);
+
+        if(!huge){
+            reuse_pages(cells(slab), Bytes - Offset);
+        }
+
+        return slab;
+    }
+
+    Slab* slab = new (map_slab(Bytes, huge)) Slab();
+
+    slab->kind = &Kind;
+    slab->next = slabs;
+    slab->arena = this;
+    slab->used = 0;
+    slab->dead.store(0);
+
+    slabs = slab;
+
+    return slab;
+}
+
+template<typename Node, std::size_t SlabBytes>
+void SlabArena<Node, SlabBytes>::reserve(unsigned int capacity){
+    //A slab cannot hold more than Capacity nodes
+    if(capacity > Capacity){
+        capacity = Capacity;
+    }
+
+    if(capacity > 0 && (!current || Capacity - current->used < capacity)){
+        current = next_slab();
+    }
+}
+
+template<typename Node, std::size_t SlabBytes>
+Node* SlabArena<Node, SlabBytes>::allocate(){
+    if(!current || current->used == Capacity){
+        current = next_slab();
+    }
+
+    SlabCell<Node>* cell = &cells(current)[current->used++];
+    cell->next = nullptr;
+
+    return new (&cell->node) Node();
+}
+
+template<typename Node, std::size_t SlabBytes>
+void SlabArena<Node, SlabBytes>::destroy(Node* node){
+    Slab* slab = slab_of(node);
+
+    node->~Node();
+    cell_of(node)->next = dead_cell();
+
+    //Only the last destroyed node of a slab sees the full count, the slab is completely carved at this point
+    if(slab->dead.fetch_add(1) + 1 == Capacity){
+        SlabArena* arena = slab->arena;
+
+        //Keep the page of the header, the cells are carved again with new links
+        if(!arena->huge){
+            release_pages(cells(slab), Bytes - Offset);
+        }
+
+        Slab* head = arena->released.load();
+
+        do {
+            slab->next_released = head;
+        } while(!arena->released.compare_exchange_weak(head, slab));
+    }
+}
+
+template<typename Node, std::size_t SlabBytes>
+bool SlabArena<Node, SlabBytes>::carved(Node* node){
+    Slab* slab = slab_of(node);
+
+    return slab && slab->kind == &Kind;
+}
+
+#endif
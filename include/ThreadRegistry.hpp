@@ -0,0 +1,222 @@
+#ifndef THREAD_REGISTRY
+#define THREAD_REGISTRY
+
+#include <cassert>
+#include <cstdlib>
+#include <new>
+#include <atomic>
+
+#include "Utils.hpp"
+
+//Slot of the calling thread in the registry, set by thread_attach()
+//Note: __thread is GCC specific
+extern __thread unsigned int thread_num;
+
+//State of the random generator of the calling thread, seeded independently for each thread by thread_attach()
+//Note: __thread is GCC specific
+extern __thread unsigned long thread_random_state;
+
+/*!
+ * Return a random number from the generator of the calling thread (xorshift64*). 
+ * The state is only written by its thread, so drawing a number never touches a shared cache line. 
+ */
+inline unsigned int thread_random(){
+    unsigned long x = thread_random_state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    thread_random_state = x;
+
+    return (x * 2685821657736338717ul) >> 32;
+}
+
+/*!
+ * Attach the calling thread to the registry. The thread receives the lowest free slot
+ * in thread_num and its NUMA node in thread_node, and its random generator is seeded.
+ * A thread must be attached before using any structure, and after being pinned if it is.
+ * \return The slot of the calling thread.
+ */
+unsigned int thread_attach();
+
+/*!
+ * Give back the slot of the calling thread. The slot can then be reused by another
+ * thread, so the calling thread must not be in the middle of an operation.
+ */
+void thread_detach();
+
+/*!
+ * Return the number of slots ever handed by the registry.
+ * \return The highest slot used plus one.
+ */
+unsigned int thread_slots();
+
+/*!
+ * A table of per-thread records indexed by the slots of the registry.
+ * The table grows by segments, each one twice as big as the previous one, so the
+ * records are never moved and can be accessed without any lock. Each record is
+ * alone on its cache lines.
+ * \param Record The type of record of a thread, value-initialized when its segment is allocated.
+ */
+template<typename Record>
+class ThreadTable {
+    public:
+        /*!
+         * \param capacity The number of records allocated at once (rounded up to a power of two).
+         */
+        explicit ThreadTable(unsigned int capacity = 1);
+        ~ThreadTable();
+
+        ThreadTable(const ThreadTable& rhs) = delete;
+        ThreadTable& operator=(const ThreadTable& rhs) = delete;
+
+        /*!
+         * Return the record of the given thread, allocating its segment if necessary.
+         * \param tid The slot of the thread.
+         */
+        Record& operator[](unsigned int tid);
+
+        /*!
+         * Return the number of records currently allocated.
+         */
+        unsigned int capacity() const;
+
+        /*!
+         * Apply the given functor to all the allocated records.
+         * \param functor The functor to apply, taking a Record&.
+         */
+        template<typename Functor>
+        void for_each(Functor functor);
+
+    private:
+        struct Cell {
+            Record record;
+        } __attribute__((aligned(CACHE_LINE_SIZE)));
+
+        static const unsigned int MaxSegments = 32;
+
+        Cell* First;            //The first segment, the only one used by most tables
+        unsigned int Shift;     //log2 of the size of the first segment
+        std::atomic<unsigned int> Allocated;
+        std::atomic<Cell*> Segments[MaxSegments];
+
+        unsigned int segment_size(unsigned int segment) const;
+        Cell* allocate(unsigned int size);
+        void destroy(Cell* cells, unsigned int size);
+        Record& grow(unsigned int tid);
+};
+
+template<typename Record>
+ThreadTable<Record>::ThreadTable(unsigned int capacity){
+    Shift = 0;
+    while((1u << Shift) < capacity){
+        ++Shift;
+    }
+
+    for(unsigned int i = 1; i < MaxSegments; ++i){
+        Segments[i].store(nullptr);
+    }
+
+    First = allocate(1u << Shift);
+    Segments[0].store(First);
+    Allocated.store(1u << Shift);
+}
+
+template<typename Record>
+ThreadTable<Record>::~ThreadTable(){
+    for(unsigned int i = 0; i < MaxSegments; ++i){
+        Cell* cells = Segments[i].load();
+
+        if(cells){
+            destroy(cells, segment_size(i));
+        }
+    }
+}
+
+template<typename Record>
+inline unsigned int ThreadTable<Record>::segment_size(unsigned int segment) const {
+    //The second segment has the same size as the first one, then they double
+    return segment == 0 ? 1u << Shift : 1u << (Shift + segment - 1);
+}
+
+template<typename Record>
+typename ThreadTable<Record>::Cell* ThreadTable<Record>::allocate(unsigned int size){
+    //new does not honour the alignment of the cells
+    void* memory = nullptr;
+    if(posix_memalign(&memory, CACHE_LINE_SIZE, size * sizeof(Cell))){
+        throw std::bad_alloc();
+    }
+
+    Cell* cells = static_cast<Cell*>(memory);
+
+    for(unsigned int i = 0; i < size; ++i){
+        new (&cells[i]) Cell();
+    }
+
+    return cells;
+}
+
+template<typename Record>
+void ThreadTable<Record>::destroy(Cell* cells, unsigned int size){
+    for(unsigned int i = 0; i < size; ++i){
+        cells[i].~Cell();
+    }
+
+    free(cells);
+}
+
+template<typename Record>
+inline Record& ThreadTable<Record>::operator[](unsigned int tid){
+    if(tid < (1u << Shift)){
+        return First[tid].record;
+    }
+
+    return grow(tid);
+}
+
+template<typename Record>
+Record& ThreadTable<Record>::grow(unsigned int tid){
+    unsigned int segment = (31 - __builtin_clz(tid)) - Shift + 1;
+    unsigned int base = segment_size(segment);
+
+#ifdef DEBUG
+    assert(segment < MaxSegments);
+#endif
+
+    Cell* cells = Segments[segment].load();
+
+    if(!cells){
+        Cell* expected = nullptr;
+        cells = allocate(segment_size(segment));
+
+        if(Segments[segment].compare_exchange_strong(expected, cells)){
+            Allocated += segment_size(segment);
+        } else {
+            //Another thread allocated the segment first
+            destroy(cells, segment_size(segment));
+            cells = expected;
+        }
+    }
+
+    return cells[tid - base].record;
+}
+
+template<typename Record>
+inline unsigned int ThreadTable<Record>::capacity() const {
+    return Allocated.load(std::memory_order_relaxed);
+}
+
+template<typename Record>
+template<typename Functor>
+void ThreadTable<Record>::for_each(Functor functor){
+    for(unsigned int i = 0; i < MaxSegments; ++i){
+        Cell* cells = Segments[i].load();
+
+        if(cells){
+            for(unsigned int j = 0; j < segment_size(i); ++j){
+                functor(cells[j].record);
+            }
+        }
+    }
+}
+
+#endif
@@ -1,6 +1,18 @@
 #ifndef UTILS
 #define UTILS
 
+//Size of a cache line, used to keep data written by different threads on different lines
+#define CACHE_LINE_SIZE 64
+
+/*!
+ * Force the compiler to read again the shared values after this point. 
+ * Needed by the retry loops that do not call any function, otherwise 
+ * their loads can be hoisted out of the loop and they never end. 
+ */
+inline void compiler_barrier(){
+    asm volatile("" ::: "memory");
+}
+
 /*!
  * Compare and Swap a pointer. 
  * \param ptr The pointer to swap.
@@ -13,4 +25,16 @@ bool inline CASPTR(T** ptr, T* old, T* value){
     return __sync_bool_compare_and_swap(ptr, old, value);
 }
 
+/*!
+ * Compare and Swap a word. 
+ * \param ptr The word to swap.
+ * \param old The expected value.
+ * \param value The new value to set. 
+ * \return true if the CAS suceeded, otherwise false. 
+ */
+template<typename T>
+bool inline CAS(T* ptr, T old, T value){
+    return __sync_bool_compare_and_swap(ptr, old, value);
+}
+
 #endif
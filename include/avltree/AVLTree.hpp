@@ -4,11 +4,13 @@
 #include <mutex>
 
 #include "hash.hpp"
+#include "NodeLock.hpp"
 #include "HazardManager.hpp"
+#include "ThreadRegistry.hpp"
 
 namespace avltree {
 
-typedef std::lock_guard<std::mutex> scoped_lock;
+typedef std::lock_guard<NodeLock> scoped_lock;
 
 static int SpinCount = 100;
 
@@ -36,12 +38,11 @@ struct Node {
     int key;
     long version;
     bool value;
+    NodeLock lock;      //In the padding after the value
     Node* parent;
     Node* left;
     Node* right;
 
-    std::mutex lock;
-
     Node* child(int direction){
         if(direction > 0){
             return right;
@@ -68,7 +69,7 @@ enum Result {
     RETRY
 };
 
-template<typename T, int Threads>
+template<typename T, int Threads, typename Reclamation = HazardPointers>
 class AVLTree {
     public:
         AVLTree();
@@ -78,6 +79,11 @@ class AVLTree {
         bool add(T value);
         bool remove(T value);
 
+        /*!
+         * Return the reclamation counters of all the managers of the structure. 
+         */
+        ReclamationStats reclamation_stats();
+
     private:
         /* Allocate new nodes */
         Node* newNode(int key);
@@ -113,51 +119,58 @@ class AVLTree {
         
         Node* rootHolder;
 
-        HazardManager<Node, Threads, 6> hazard;
+        typename Reclaimer<Reclamation, Node, Threads, 6>::type hazard;
         
-        unsigned int Current[Threads];
+        ThreadTable<unsigned int> Current;     //Number of hazard pointers published by each thread
 };
 
 static Node* fixHeight_nl(Node* n);
 static int height(Node* node);
 static int nodeCondition(Node* node);
 
-template<typename T, int Threads>
-AVLTree<T, Threads>::AVLTree(){
+template<typename T, int Threads, typename Reclamation>
+AVLTree<T, Threads, Reclamation>::AVLTree() : Current(Threads) {
     rootHolder = newNode(std::numeric_limits<int>::min());
-
-    for(unsigned int i = 0; i < Threads; ++i){
-        Current[i] = 0;
-    }
 }
 
-template<typename T, int Threads>
-AVLTree<T, Threads>::~AVLTree(){
+template<typename T, int Threads, typename Reclamation>
+AVLTree<T, Threads, Reclamation>::~AVLTree(){
     hazard.releaseNode(rootHolder);
 }
 
-template<typename T, int Threads>
-void AVLTree<T, Threads>::publish(Node* ref){
-    hazard.publish(ref, Current[thread_num]);
-    ++Current[thread_num];
+template<typename T, int Threads, typename Reclamation>
+ReclamationStats AVLTree<T, Threads, Reclamation>::reclamation_stats(){
+    ReclamationStats stats = hazard.stats();
+
+    return stats;
+}
+
+template<typename T, int Threads, typename Reclamation>
+void AVLTree<T, Threads, Reclamation>::publish(Node* ref){
+    unsigned int& current = Current[thread_num];
+
+    hazard.publish(ref, current);
+    ++current;
 }
 
-template<typename T, int Threads>
-void AVLTree<T, Threads>::releaseAll(){
-    for(unsigned int i = 0; i < Current[thread_num]; ++i){
+template<typename T, int Threads, typename Reclamation>
+void AVLTree<T, Threads, Reclamation>::releaseAll(){
+    unsigned int& current = Current[thread_num];
+
+    for(unsigned int i = 0; i < current; ++i){
         hazard.release(i);
     }
     
-    Current[thread_num] = 0;
+    current = 0;
 }
 
-template<typename T, int Threads>
-Node* AVLTree<T, Threads>::newNode(int key){
+template<typename T, int Threads, typename Reclamation>
+Node* AVLTree<T, Threads, Reclamation>::newNode(int key){
     return newNode(1, key, 0L, false, nullptr, nullptr, nullptr);
 }
 
-template<typename T, int Threads>
-Node* AVLTree<T, Threads>::newNode(int height, int key, long version, bool value, Node* parent, Node* left, Node* right){
+template<typename T, int Threads, typename Reclamation>
+Node* AVLTree<T, Threads, Reclamation>::newNode(int height, int key, long version, bool value, Node* parent, Node* left, Node* right){
     Node* node = hazard.getFreeNode();
     
     node->height = height;
@@ -171,8 +184,10 @@ Node* AVLTree<T, Threads>::newNode(int height, int key, long version, bool value
     return node;
 }
 
-template<typename T, int Threads>
-bool AVLTree<T, Threads>::contains(T value){
+template<typename T, int Threads, typename Reclamation>
+bool AVLTree<T, Threads, Reclamation>::contains(T value){
+    CriticalSection<decltype(hazard)> critical(hazard);
+
     int key = hash(value);
 
     while(true){
@@ -199,8 +214,8 @@ bool AVLTree<T, Threads>::contains(T value){
     }
 }
 
-template<typename T, int Threads>
-Result AVLTree<T, Threads>::attemptGet(int key, Node* node, int dir, long nodeV){
+template<typename T, int Threads, typename Reclamation>
+Result AVLTree<T, Threads, Reclamation>::attemptGet(int key, Node* node, int dir, long nodeV){
     while(true){
         Node* child = node->child(dir);
 
@@ -253,18 +268,22 @@ inline Result noUpdateResult(Function func, bool/* prev*/){
     return func == UpdateIfAbsent ? FOUND : NOT_FOUND;
 }
 
-template<typename T, int Threads>
-bool AVLTree<T, Threads>::add(T value){
+template<typename T, int Threads, typename Reclamation>
+bool AVLTree<T, Threads, Reclamation>::add(T value){
+    CriticalSection<decltype(hazard)> critical(hazard);
+
     return updateUnderRoot(hash(value), UpdateIfAbsent, false, true, rootHolder) == NOT_FOUND;
 }
 
-template<typename T, int Threads>
-bool AVLTree<T, Threads>::remove(T value){
+template<typename T, int Threads, typename Reclamation>
+bool AVLTree<T, Threads, Reclamation>::remove(T value){
+    CriticalSection<decltype(hazard)> critical(hazard);
+
     return updateUnderRoot(hash(value), UpdateIfPresent, true, false, rootHolder) == FOUND;
 }
 
-template<typename T, int Threads>
-Result AVLTree<T, Threads>::updateUnderRoot(int key, Function func, bool expected, bool newValue, Node* holder){
+template<typename T, int Threads, typename Reclamation>
+Result AVLTree<T, Threads, Reclamation>::updateUnderRoot(int key, Function func, bool expected, bool newValue, Node* holder){
     while(true){
         Node* right = holder->right;
 
@@ -291,8 +310,8 @@ Result AVLTree<T, Threads>::updateUnderRoot(int key, Function func, bool expecte
     }
 }
 
-template<typename T, int Threads>
-bool AVLTree<T, Threads>::attemptInsertIntoEmpty(int key, bool value, Node* holder){
+template<typename T, int Threads, typename Reclamation>
+bool AVLTree<T, Threads, Reclamation>::attemptInsertIntoEmpty(int key, bool value, Node* holder){
     publish(holder);
     scoped_lock lock(holder->lock);
 
@@ -307,8 +326,8 @@ bool AVLTree<T, Threads>::attemptInsertIntoEmpty(int key, bool value, Node* hold
     }
 }
 
-template<typename T, int Threads>
-Result AVLTree<T, Threads>::attemptUpdate(int key, Function func, bool expected, bool newValue, Node* parent, Node* node, long nodeOVL){
+template<typename T, int Threads, typename Reclamation>
+Result AVLTree<T, Threads, Reclamation>::attemptUpdate(int key, Function func, bool expected, bool newValue, Node* parent, Node* node, long nodeOVL){
     int cmp = key - node->key;
     if(cmp == 0){
         return attemptNodeUpdate(func, expected, newValue, parent, node);
@@ -382,8 +401,8 @@ Result AVLTree<T, Threads>::attemptUpdate(int key, Function func, bool expected,
     }
 }
 
-template<typename T, int Threads>
-Result AVLTree<T, Threads>::attemptNodeUpdate(Function func, bool expected, bool newValue, Node* parent, Node* node){
+template<typename T, int Threads, typename Reclamation>
+Result AVLTree<T, Threads, Reclamation>::attemptNodeUpdate(Function func, bool expected, bool newValue, Node* parent, Node* node){
     if(!newValue){
         if(!node->value){
             return NOT_FOUND;
@@ -460,8 +479,8 @@ Result AVLTree<T, Threads>::attemptNodeUpdate(Function func, bool expected, bool
     }
 }
 
-template<typename T, int Threads>
-void AVLTree<T, Threads>::waitUntilNotChanging(Node* node){
+template<typename T, int Threads, typename Reclamation>
+void AVLTree<T, Threads, Reclamation>::waitUntilNotChanging(Node* node){
     long version = node->version;
 
     if(isShrinking(version)){
@@ -471,13 +490,12 @@ void AVLTree<T, Threads>::waitUntilNotChanging(Node* node){
             }
         }
             
-        node->lock.lock();
-        node->lock.unlock();
+        node->lock.waitUnlocked();
     }
 }
 
-template<typename T, int Threads>
-bool AVLTree<T, Threads>::attemptUnlink_nl(Node* parent, Node* node){
+template<typename T, int Threads, typename Reclamation>
+bool AVLTree<T, Threads, Reclamation>::attemptUnlink_nl(Node* parent, Node* node){
     Node* parentL = parent->left;
     Node* parentR = parent->right;
 
@@ -539,8 +557,8 @@ int nodeCondition(Node* node){
     return hN != hNRepl ? hNRepl : NothingRequired;
 }
 
-template<typename T, int Threads>
-void AVLTree<T, Threads>::fixHeightAndRebalance(Node* node){
+template<typename T, int Threads, typename Reclamation>
+void AVLTree<T, Threads, Reclamation>::fixHeightAndRebalance(Node* node){
     while(node && node->parent){
         int condition = nodeCondition(node);
         if(condition == NothingRequired || isUnlinked(node->version)){
@@ -586,8 +604,8 @@ Node* fixHeight_nl(Node* node){
     }
 }
         
-template<typename T, int Threads>
-Node* AVLTree<T, Threads>::rebalance_nl(Node* nParent, Node* n){
+template<typename T, int Threads, typename Reclamation>
+Node* AVLTree<T, Threads, Reclamation>::rebalance_nl(Node* nParent, Node* n){
     Node* nL = n->left;
     Node* nR = n->right;
 
@@ -618,8 +636,8 @@ Node* AVLTree<T, Threads>::rebalance_nl(Node* nParent, Node* n){
     }
 }
 
-template<typename T, int Threads>
-Node* AVLTree<T, Threads>::rebalanceToRight_nl(Node* nParent, Node* n, Node* nL, int hR0){
+template<typename T, int Threads, typename Reclamation>
+Node* AVLTree<T, Threads, Reclamation>::rebalanceToRight_nl(Node* nParent, Node* n, Node* nL, int hR0){
     publish(nL);
     scoped_lock lock(nL->lock);
 
@@ -637,7 +655,7 @@ Node* AVLTree<T, Threads>::rebalanceToRight_nl(Node* nParent, Node* n, Node* nL,
             return rotateRight_nl(nParent, n, nL, hR0, hLL0, nLR, hLR0);
         } else {
             {
-                if(reinterpret_cast<long>(&nLR->lock) == 0x30){
+                if(!nLR){
                     return n;
                 }
                 scoped_lock subLock(nLR->lock);
@@ -659,8 +677,8 @@ Node* AVLTree<T, Threads>::rebalanceToRight_nl(Node* nParent, Node* n, Node* nL,
     }
 }
 
-template<typename T, int Threads>
-Node* AVLTree<T, Threads>::rebalanceToLeft_nl(Node* nParent, Node* n, Node* nR, int hL0){
+template<typename T, int Threads, typename Reclamation>
+Node* AVLTree<T, Threads, Reclamation>::rebalanceToLeft_nl(Node* nParent, Node* n, Node* nR, int hL0){
     publish(nR);
     scoped_lock lock(nR->lock);
 
@@ -696,8 +714,8 @@ Node* AVLTree<T, Threads>::rebalanceToLeft_nl(Node* nParent, Node* n, Node* nR,
     }
 }
         
-template<typename T, int Threads>
-Node* AVLTree<T, Threads>::rotateRight_nl(Node* nParent, Node* n, Node* nL, int hR, int hLL, Node* nLR, int hLR){
+template<typename T, int Threads, typename Reclamation>
+Node* AVLTree<T, Threads, Reclamation>::rotateRight_nl(Node* nParent, Node* n, Node* nL, int hR, int hLL, Node* nLR, int hLR){
     long nodeOVL = n->version;
     Node* nPL = nParent->left;
     n->version = beginChange(nodeOVL);
@@ -736,8 +754,8 @@ Node* AVLTree<T, Threads>::rotateRight_nl(Node* nParent, Node* n, Node* nL, int
     return fixHeight_nl(nParent);
 }
 
-template<typename T, int Threads>
-Node* AVLTree<T, Threads>::rotateLeft_nl(Node* nParent, Node* n, int hL, Node* nR, Node* nRL, int hRL, int hRR){
+template<typename T, int Threads, typename Reclamation>
+Node* AVLTree<T, Threads, Reclamation>::rotateLeft_nl(Node* nParent, Node* n, int hL, Node* nR, Node* nRL, int hRL, int hRR){
     long nodeOVL = n->version;
     Node* nPL = nParent->left;
     n->version = beginChange(nodeOVL);
@@ -776,8 +794,8 @@ Node* AVLTree<T, Threads>::rotateLeft_nl(Node* nParent, Node* n, int hL, Node* n
     return fixHeight_nl(nParent);
 }
 
-template<typename T, int Threads>
-Node* AVLTree<T, Threads>::rotateRightOverLeft_nl(Node* nParent, Node* n, Node* nL, int hR, int hLL, Node* nLR, int hLRL){
+template<typename T, int Threads, typename Reclamation>
+Node* AVLTree<T, Threads, Reclamation>::rotateRightOverLeft_nl(Node* nParent, Node* n, Node* nL, int hR, int hLL, Node* nLR, int hLRL){
     long nodeOVL = n->version;
     long leftOVL = nL->version;
 
@@ -835,8 +853,8 @@ Node* AVLTree<T, Threads>::rotateRightOverLeft_nl(Node* nParent, Node* n, Node*
     return fixHeight_nl(nParent);
 }
 
-template<typename T, int Threads>
-Node* AVLTree<T, Threads>::rotateLeftOverRight_nl(Node* nParent, Node* n, int hL, Node* nR, Node* nRL, int hRR, int hRLR){
+template<typename T, int Threads, typename Reclamation>
+Node* AVLTree<T, Threads, Reclamation>::rotateLeftOverRight_nl(Node* nParent, Node* n, int hL, Node* nR, Node* nRL, int hRR, int hRLR){
     long nodeOVL = n->version;
     long rightOVL = nR->version;
 
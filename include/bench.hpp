@@ -6,4 +6,9 @@
  */
 void bench();
 
+/*!
+ * Bench the structures with the threads pinned on the CPUs of the NUMA nodes in different orders
+ */
+void numa_bench();
+
 #endif
@@ -6,11 +6,13 @@
 #include <cmath>
 
 #include "Utils.hpp"
+#include "NodeLock.hpp"
 #include "HazardManager.hpp"
+#include "ThreadRegistry.hpp"
 
 namespace cbtree {
 
-typedef std::lock_guard<std::mutex> scoped_lock;
+typedef std::lock_guard<NodeLock> scoped_lock;
     
 static const int SpinCount = 100;
 
@@ -78,7 +80,7 @@ struct Node {
     int rcnt;
     int lcnt;
 
-    std::mutex lock;
+    NodeLock lock;      //In the padding after the counters
 
     Node* child(char dir){
         return dir == Left ? left : right;
@@ -93,18 +95,22 @@ struct Node {
     }
 
     void waitUntilChangeCompleted(long ovl) {
+        //The caller will retry, it must see the new state of the nodes
+        compiler_barrier();
+
         if (!isChanging(ovl)) {
             return;
         }
 
         for (int tries = 0; tries < SpinCount; ++tries) {
+            compiler_barrier();
+
             if (changeOVL != ovl) {
                 return;
             }
         }
 
-        lock.lock();
-        lock.unlock();
+        lock.waitUnlocked();
     }
 };
 
@@ -114,7 +120,7 @@ enum Result {
     RETRY
 };
 
-template<typename T, int Threads>
+template<typename T, int Threads, typename Reclamation = HazardPointers>
 class CBTree {
     public:
         CBTree();
@@ -124,21 +130,33 @@ class CBTree {
         bool remove(T value);
         bool contains(T value);
 
+        /*!
+         * Return the reclamation counters of all the managers of the structure. 
+         */
+        ReclamationStats reclamation_stats();
+
     private:
         Node* rootHolder;
 
         std::atomic<int> size;
         std::atomic<int> logSize;
-        int local_size[Threads];
+        /*!
+         * The state of a single thread.
+         */
+        struct ThreadState {
+            int local_size;         //Changes of the size not yet added to size
+            unsigned int Current;   //Number of hazard pointers published
+        };
+
+        ThreadTable<ThreadState> states;
 
         int NEW_LOG_CALCULATION_THRESHOLD;
         
         void publish(Node* ref);
         void releaseAll();
 
-        HazardManager<Node, Threads, 5> hazard;
+        typename Reclaimer<Reclamation, Node, Threads, 5>::type hazard;
         
-        unsigned int Current[Threads];
         void deep_release(Node* node);
         
         /* Allocate new nodes */
@@ -166,24 +184,19 @@ class CBTree {
         void rotateLeftOverRight(Node* nParent, Node* n, Node* nR, Node* nRL);
 };
 
-template<typename T, int Threads>
-CBTree<T, Threads>::CBTree(){
+template<typename T, int Threads, typename Reclamation>
+CBTree<T, Threads, Reclamation>::CBTree() : states(Threads) {
     rootHolder = newNode(std::numeric_limits<int>::min(), false, nullptr, 0L, nullptr, nullptr); 
     rootHolder->ncnt = std::numeric_limits<int>::max();
 
     size.store(0);
     logSize.store(-1);
 
-    for(int i = 0; i < Threads; ++i){
-        local_size[i] = 0;
-        Current[i] = 0;
-    }
-
     NEW_LOG_CALCULATION_THRESHOLD = 15;//std::log(2 * Threads * Threads);
 }
 
-template<typename T, int Threads>
-void CBTree<T, Threads>::deep_release(Node* node){
+template<typename T, int Threads, typename Reclamation>
+void CBTree<T, Threads, Reclamation>::deep_release(Node* node){
     if(node->left){
         deep_release(node->left);
     }
@@ -197,28 +210,39 @@ void CBTree<T, Threads>::deep_release(Node* node){
     }
 }
 
-template<typename T, int Threads>
-CBTree<T, Threads>::~CBTree(){
+template<typename T, int Threads, typename Reclamation>
+CBTree<T, Threads, Reclamation>::~CBTree(){
     deep_release(rootHolder);
 }
 
-template<typename T, int Threads>
-void CBTree<T, Threads>::publish(Node* ref){
-    hazard.publish(ref, Current[thread_num]);
-    ++Current[thread_num];
+template<typename T, int Threads, typename Reclamation>
+ReclamationStats CBTree<T, Threads, Reclamation>::reclamation_stats(){
+    ReclamationStats stats = hazard.stats();
+
+    return stats;
+}
+
+template<typename T, int Threads, typename Reclamation>
+void CBTree<T, Threads, Reclamation>::publish(Node* ref){
+    ThreadState& state = states[thread_num];
+
+    hazard.publish(ref, state.Current);
+    ++state.Current;
 }
 
-template<typename T, int Threads>
-void CBTree<T, Threads>::releaseAll(){
-    for(unsigned int i = 0; i < Current[thread_num]; ++i){
+template<typename T, int Threads, typename Reclamation>
+void CBTree<T, Threads, Reclamation>::releaseAll(){
+    ThreadState& state = states[thread_num];
+
+    for(unsigned int i = 0; i < state.Current; ++i){
         hazard.release(i);
     }
     
-    Current[thread_num] = 0;
+    state.Current = 0;
 }
 
-template<typename T, int Threads>
-Node* CBTree<T, Threads>::newNode(int key, bool value, Node* parent, long changeOVL, Node* left, Node* right){
+template<typename T, int Threads, typename Reclamation>
+Node* CBTree<T, Threads, Reclamation>::newNode(int key, bool value, Node* parent, long changeOVL, Node* left, Node* right){
     Node* node = hazard.getFreeNode();
     
     node->key = key;
@@ -235,8 +259,10 @@ Node* CBTree<T, Threads>::newNode(int key, bool value, Node* parent, long change
     return node;
 }
 
-template<typename T, int Threads>
-bool CBTree<T, Threads>::contains(T value){
+template<typename T, int Threads, typename Reclamation>
+bool CBTree<T, Threads, Reclamation>::contains(T value){
+    CriticalSection<decltype(hazard)> critical(hazard);
+
     int key = hash(value);
 
     while(true){
@@ -263,8 +289,8 @@ bool CBTree<T, Threads>::contains(T value){
     }
 }
 
-template<typename T, int Threads>
-Result CBTree<T, Threads>::attemptGet(int key, Node* node, char dirToC, long nodeOVL, int height){
+template<typename T, int Threads, typename Reclamation>
+Result CBTree<T, Threads, Reclamation>::attemptGet(int key, Node* node, char dirToC, long nodeOVL, int height){
     while(true){
         Node* child = node->child(dirToC);
 
@@ -322,8 +348,10 @@ Result CBTree<T, Threads>::attemptGet(int key, Node* node, char dirToC, long nod
     }
 }
 
-template<typename T, int Threads>
-bool CBTree<T, Threads>::add(T value){
+template<typename T, int Threads, typename Reclamation>
+bool CBTree<T, Threads, Reclamation>::add(T value){
+    CriticalSection<decltype(hazard)> critical(hazard);
+
     if(update(hash(value)) == NOT_FOUND){
         int log_size = logSize.load();
 
@@ -334,11 +362,13 @@ bool CBTree<T, Threads>::add(T value){
                 logSize.compare_exchange_strong(log_size, next_log_size);
             }
         } else {
-            ++local_size[thread_num];
+            int& local_size = states[thread_num].local_size;
+            ++local_size;
 
-            if(local_size[thread_num] >= Threads){
-                int new_size = (size += local_size[thread_num]);
-                local_size[thread_num] = 0;
+            //Flush after as many changes as there are threads, the threads attached so far
+            if(local_size >= static_cast<int>(thread_slots())){
+                int new_size = (size += local_size);
+                local_size = 0;
                 int next_log_size = log_size + 1;
                 if(new_size >= (1 << next_log_size)){
                     logSize.compare_exchange_strong(log_size, next_log_size);
@@ -352,8 +382,10 @@ bool CBTree<T, Threads>::add(T value){
     }
 }
 
-template<typename T, int Threads>
-bool CBTree<T, Threads>::remove(T value){
+template<typename T, int Threads, typename Reclamation>
+bool CBTree<T, Threads, Reclamation>::remove(T value){
+    CriticalSection<decltype(hazard)> critical(hazard);
+
     int key = hash(value);
 
     while(true){
@@ -379,10 +411,11 @@ bool CBTree<T, Threads>::remove(T value){
                                 logSize.compare_exchange_strong(log_size, log_size - 1);
                             }
                         } else {
-                            --local_size[thread_num];
-                            if(local_size[thread_num] <= -Threads){
-                                int new_size = (size += local_size[thread_num]);
-                                local_size[thread_num] = 0;
+                            int& local_size = states[thread_num].local_size;
+                            --local_size;
+                            if(local_size <= -static_cast<int>(thread_slots())){
+                                int new_size = (size += local_size);
+                                local_size = 0;
                                 if(new_size < (1 << log_size)){
                                     logSize.compare_exchange_strong(log_size, log_size - 1);
                                 }
@@ -403,8 +436,8 @@ bool CBTree<T, Threads>::remove(T value){
     }
 }
 
-template<typename T, int Threads>
-Result CBTree<T, Threads>::update(int key){
+template<typename T, int Threads, typename Reclamation>
+Result CBTree<T, Threads, Reclamation>::update(int key){
     while(true){
         Node* right = rootHolder->right;
 
@@ -427,8 +460,8 @@ Result CBTree<T, Threads>::update(int key){
     }
 }
 
-template<typename T, int Threads>
-bool CBTree<T, Threads>::attemptInsertIntoEmpty(int key){
+template<typename T, int Threads, typename Reclamation>
+bool CBTree<T, Threads, Reclamation>::attemptInsertIntoEmpty(int key){
     publish(rootHolder);
     scoped_lock lock(rootHolder->lock);
 
@@ -442,8 +475,8 @@ bool CBTree<T, Threads>::attemptInsertIntoEmpty(int key){
     }
 }
 
-template<typename T, int Threads>
-Result CBTree<T, Threads>::attemptUpdate(int key, Node* parent, Node* node, long nodeOVL, int height){
+template<typename T, int Threads, typename Reclamation>
+Result CBTree<T, Threads, Reclamation>::attemptUpdate(int key, Node* parent, Node* node, long nodeOVL, int height){
     int cmp = key - node->key;
     if(cmp == 0){
         int log_size = logSize.load();
@@ -512,6 +545,7 @@ Result CBTree<T, Threads>::attemptUpdate(int key, Node* parent, Node* node, long
                 child->waitUntilChangeCompleted(childOVL);
             } else if(child != node->child(dirToC)){
                 //Retry
+                compiler_barrier();
             } else {
                 if(hasShrunkOrUnlinked(nodeOVL, node->changeOVL)){
                     return RETRY;
@@ -536,8 +570,8 @@ Result CBTree<T, Threads>::attemptUpdate(int key, Node* parent, Node* node, long
     }
 }
 
-template<typename T, int Threads>
-Result CBTree<T, Threads>::attemptNodeUpdate(bool newValue, Node* parent, Node* node){
+template<typename T, int Threads, typename Reclamation>
+Result CBTree<T, Threads, Reclamation>::attemptNodeUpdate(bool newValue, Node* parent, Node* node){
     if(!newValue){
         if(!node->value){
             return NOT_FOUND;
@@ -594,8 +628,8 @@ Result CBTree<T, Threads>::attemptNodeUpdate(bool newValue, Node* parent, Node*
     }
 }
 
-template<typename T, int Threads>
-bool CBTree<T, Threads>::attemptUnlink_nl(Node* parent, Node* node){
+template<typename T, int Threads, typename Reclamation>
+bool CBTree<T, Threads, Reclamation>::attemptUnlink_nl(Node* parent, Node* node){
     Node* parentL = parent->left;
     Node* parentR = parent->right;
 
@@ -629,8 +663,8 @@ bool CBTree<T, Threads>::attemptUnlink_nl(Node* parent, Node* node){
     return true;
 }
 
-template<typename T, int Threads>
-Result CBTree<T, Threads>::attemptRemove(int key, Node* parent, Node* node, long nodeOVL, int height){
+template<typename T, int Threads, typename Reclamation>
+Result CBTree<T, Threads, Reclamation>::attemptRemove(int key, Node* parent, Node* node, long nodeOVL, int height){
     int cmp = key - node->key;
     if(cmp == 0){
         return attemptNodeUpdate(false, parent, node);
@@ -654,6 +688,7 @@ Result CBTree<T, Threads>::attemptRemove(int key, Node* parent, Node* node, long
                 child->waitUntilChangeCompleted(childOVL);
             } else if(child != node->child(dirToC)){
                 //Retry
+                compiler_barrier();
             } else {
                 if(hasShrunkOrUnlinked(nodeOVL, node->changeOVL)){
                     return RETRY;
@@ -668,8 +703,8 @@ Result CBTree<T, Threads>::attemptRemove(int key, Node* parent, Node* node, long
     }
 }
         
-template<typename T, int Threads>
-void CBTree<T, Threads>::SemiSplay(Node* child){
+template<typename T, int Threads, typename Reclamation>
+void CBTree<T, Threads, Reclamation>::SemiSplay(Node* child){
     while(child && child->parent && child->parent->parent){
         Node* node = child->parent;
         Node* parent = node->parent;
@@ -747,8 +782,8 @@ void CBTree<T, Threads>::SemiSplay(Node* child){
     }
 }
 
-template<typename T, int Threads>
-void CBTree<T, Threads>::RebalanceAtTarget(Node* parent, Node* node){
+template<typename T, int Threads, typename Reclamation>
+void CBTree<T, Threads, Reclamation>::RebalanceAtTarget(Node* parent, Node* node){
     int ncnt;
     int pcnt;
     int n_other_cnt;
@@ -834,8 +869,8 @@ void CBTree<T, Threads>::RebalanceAtTarget(Node* parent, Node* node){
     releaseAll();
 }
 
-template<typename T, int Threads>
-void CBTree<T, Threads>::RebalanceNew(Node* parent, char dirToC){
+template<typename T, int Threads, typename Reclamation>
+void CBTree<T, Threads, Reclamation>::RebalanceNew(Node* parent, char dirToC){
     Node* node = parent->child(dirToC);
     int ncnt;
     int pcnt;
@@ -931,8 +966,8 @@ void CBTree<T, Threads>::RebalanceNew(Node* parent, char dirToC){
     releaseAll();
 }
 
-template<typename T, int Threads>
-void CBTree<T, Threads>::rotateRight(Node* nParent, Node* n, Node* nL, Node* nLR){
+template<typename T, int Threads, typename Reclamation>
+void CBTree<T, Threads, Reclamation>::rotateRight(Node* nParent, Node* n, Node* nL, Node* nLR){
     long nodeOVL = n->changeOVL;
     long leftOVL = nL->changeOVL;
 
@@ -959,8 +994,8 @@ void CBTree<T, Threads>::rotateRight(Node* nParent, Node* n, Node* nL, Node* nLR
     n->changeOVL = endShrink(nodeOVL);
 }
 
-template<typename T, int Threads>
-void CBTree<T, Threads>::rotateLeft(Node* nParent, Node* n, Node* nR, Node* nRL){
+template<typename T, int Threads, typename Reclamation>
+void CBTree<T, Threads, Reclamation>::rotateLeft(Node* nParent, Node* n, Node* nR, Node* nRL){
     long nodeOVL = n->changeOVL;
     long rightOVL = nR->changeOVL;
 
@@ -988,8 +1023,8 @@ void CBTree<T, Threads>::rotateLeft(Node* nParent, Node* n, Node* nR, Node* nRL)
     n->changeOVL = endShrink(nodeOVL);
 }
 
-template<typename T, int Threads>
-void CBTree<T, Threads>::rotateRightOverLeft(Node* nParent, Node* n, Node* nL, Node* nLR){
+template<typename T, int Threads, typename Reclamation>
+void CBTree<T, Threads, Reclamation>::rotateRightOverLeft(Node* nParent, Node* n, Node* nL, Node* nLR){
     long nodeOVL = n->changeOVL;
     long leftOVL = nL->changeOVL;
     long leftROVL = nLR->changeOVL;
@@ -1030,8 +1065,8 @@ void CBTree<T, Threads>::rotateRightOverLeft(Node* nParent, Node* n, Node* nL, N
     n->changeOVL = endShrink(nodeOVL);
 }
 
-template<typename T, int Threads>
-void CBTree<T, Threads>::rotateLeftOverRight(Node* nParent, Node* n, Node* nR, Node* nRL){
+template<typename T, int Threads, typename Reclamation>
+void CBTree<T, Threads, Reclamation>::rotateLeftOverRight(Node* nParent, Node* n, Node* nR, Node* nRL){
     long nodeOVL = n->changeOVL;
     long rightOVL = nR->changeOVL;
     long rightLOVL = nRL->changeOVL;
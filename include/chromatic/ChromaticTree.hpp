@@ -0,0 +1,788 @@
+#ifndef CHROMATIC_TREE
+#define CHROMATIC_TREE
+
+#include <atomic>
+#include <limits>
+
+#include "hash.hpp"
+#include "Utils.hpp"
+#include "EpochManager.hpp"
+#include "ThreadRegistry.hpp"
+
+namespace chromatic {
+
+/*!
+ * An update word, as in the NBBST: the slot of the thread whose descriptor froze the node and
+ * the sequence number of the operation in this thread, with the lowest bit set once the node
+ * is finalized, that is removed from the tree by the operation. A word is never seen twice.
+ */
+typedef unsigned long Update;
+
+static const unsigned int ThreadBits = 16;
+
+inline Update makeUpdate(unsigned int thread, unsigned long sequence){
+    return (sequence << (ThreadBits + 1)) | (static_cast<unsigned long>(thread) << 1);
+}
+
+inline unsigned int getThread(Update update){
+    return (update >> 1) & ((1ul << ThreadBits) - 1);
+}
+
+inline unsigned long getSequence(Update update){
+    return update >> (ThreadBits + 1);
+}
+
+inline bool IsMarked(Update update){
+    return update & 1l;
+}
+
+inline Update Mark(Update update){
+    return update | 1l;
+}
+
+inline Update Unmark(Update update){
+    return update & (~0l - 1);
+}
+
+/*!
+ * A node of the tree, the elements are in the leaves. The weights never change, a node
+ * is replaced by a copy to change its weight.
+ */
+struct Node {
+    int key;
+    int weight;         //0 for a red node, 1 for a black node, more for an overweight node
+    Update update;
+    Node* left;
+    Node* right;
+};
+
+/*!
+ * The states of an operation, in the status word of its descriptor.
+ */
+enum OperationState {
+    IN_PROGRESS = 0,
+    COMMITTED   = 1,
+    ABORTED     = 2,
+    FINISHED    = 3     //The descriptor already describes a later operation, this one is committed or aborted
+};
+
+static const unsigned long ALL_FROZEN = 4;
+
+/*!
+ * A status word: the sequence number of the operation of the descriptor, the flag set
+ * once all its nodes are frozen and its state.
+ */
+inline unsigned long makeStatus(unsigned long sequence, unsigned long flags){
+    return (sequence << 3) | flags;
+}
+
+static const unsigned int MaxNodes = 5;
+
+/*!
+ * An operation replacing a child of a node by a new subtree (SCX). It freezes the nodes it depends on,
+ * the parent first, by setting their update word to its own word if they have not changed since they
+ * have been read, then marks the nodes it removes from the tree and swaps the child.
+ */
+struct Info {
+    Node* nodes[MaxNodes];      //The nodes to freeze, the first one is the parent of the replaced child
+    Update updates[MaxNodes];   //The update word of each node when its children have been read
+    unsigned int count;
+    unsigned int finalized;     //A bit for each node removed from the tree
+    Node** field;
+    Node* old;
+    Node* child;
+    Update update;              //The word of the operation
+};
+
+/*!
+ * The descriptor of a thread, reused by all its operations like in the NBBST. The sequence number
+ * is incremented before the fields are written, so a helper reading the fields of a previous
+ * operation sees that it is over.
+ */
+struct Descriptor {
+    std::atomic<unsigned long> status;
+    Info info;
+};
+
+/*!
+ * A lock-free chromatic tree, a relaxed red-black tree whose insertions, removals and rebalancing
+ * steps are done with the helping scheme of the NBBST, generalized to any number of nodes. The updates
+ * only replace a few nodes and leave violations of the balance, each one then fixes the violations
+ * on the path to its key, so the tree stays balanced even with sorted insertions.
+ * The helpers read the nodes of the operations they help, which cannot be validated with hazard
+ * pointers, so the nodes are protected by epochs by default.
+ */
+template<typename T, int Threads, typename Reclamation = Epochs>
+class ChromaticTree {
+    public:
+        ChromaticTree();
+        ~ChromaticTree();
+
+        bool contains(T value);
+        bool add(T value);
+        bool remove(T value);
+
+        /*!
+         * Return the reclamation counters of all the managers of the structure.
+         */
+        ReclamationStats reclamation_stats();
+
+    private:
+        /*!
+         * The children of a node and its update word when they have been read.
+         */
+        struct Snapshot {
+            Node* left;
+            Node* right;
+            Update update;
+        };
+
+        struct SearchResult {
+            Node* ggp;
+            Node* gp;
+            Node* p;
+            Node* l;
+        };
+
+        Node* newNode(int key, int weight, Node* left, Node* right);
+        Node* copy(Node* node, int weight, const Snapshot& snapshot);
+        Node** childField(Node* parent, const Snapshot& snapshot, Node* child);
+
+        void search(int key, SearchResult& result);
+
+        /*!
+         * Read the children of the node if it is not frozen (LLX).
+         * \return false if the node is frozen by an operation in progress, after helping it, or finalized.
+         */
+        bool llx(Node* node, Snapshot& snapshot);
+
+        /* Prepare the descriptor of the calling thread for a new operation */
+        Info* newInfo();
+        void addNode(Info* op, Node* node, const Snapshot& snapshot, bool finalize);
+
+        /*!
+         * Replace the child of the first node of the operation if none of its nodes has changed
+         * since it has been read (SCX).
+         * \return true if the child has been replaced.
+         */
+        bool scx(Info* op, Node** field, Node* old, Node* child);
+
+        OperationState getState(Update update);
+        void help(Update update);
+        bool help(Info* op);
+
+        /*!
+         * Fix the violations on the path to the key until there is none.
+         */
+        void cleanup(int key);
+        bool isViolation(Node* parent, Node* node);
+        void fixRed(Node* u, Node* g, Node* p, Node* v);
+        void fixOverweight(Node* ggp, Node* u, Node* p, Node* v);
+
+        /* Release the nodes removed by a committed operation, or the nodes of an operation that failed */
+        void releaseFinalized(Info* op);
+        void releaseNew(Node* top, Node* a, Node* b = nullptr, Node* c = nullptr);
+
+        Node* entry;
+
+        typename Reclaimer<Reclamation, Node, Threads>::type nodes;
+
+        ThreadTable<Descriptor> descriptors;
+};
+
+template<typename T, int Threads, typename Reclamation>
+Node* ChromaticTree<T, Threads, Reclamation>::newNode(int key, int weight, Node* left, Node* right){
+    Node* node = nodes.getFreeNode();
+
+    node->key = key;
+    node->weight = weight;
+    node->update = 0;
+    node->left = left;
+    node->right = right;
+
+    return node;
+}
+
+template<typename T, int Threads, typename Reclamation>
+ChromaticTree<T, Threads, Reclamation>::ChromaticTree() : descriptors(Threads) {
+    //The elements are all on the left of the entry, the leaf with the maximal key stays the rightmost one
+    entry = newNode(std::numeric_limits<int>::max(), 1,
+            newNode(std::numeric_limits<int>::max(), 1, nullptr, nullptr),
+            newNode(std::numeric_limits<int>::max(), 1, nullptr, nullptr));
+}
+
+template<typename T, int Threads, typename Reclamation>
+ChromaticTree<T, Threads, Reclamation>::~ChromaticTree(){
+    //All the nodes are destroyed with the arenas of the manager
+}
+
+template<typename T, int Threads, typename Reclamation>
+ReclamationStats ChromaticTree<T, Threads, Reclamation>::reclamation_stats(){
+    ReclamationStats stats = nodes.stats();
+
+    return stats;
+}
+
+template<typename T, int Threads, typename Reclamation>
+void ChromaticTree<T, Threads, Reclamation>::search(int key, SearchResult& result){
+    result.ggp = nullptr;
+    result.gp = nullptr;
+    result.p = nullptr;
+
+    Node* l = entry;
+
+    while(l->left){
+        result.ggp = result.gp;
+        result.gp = result.p;
+        result.p = l;
+
+        l = key < l->key ? l->left : l->right;
+    }
+
+    result.l = l;
+}
+
+template<typename T, int Threads, typename Reclamation>
+bool ChromaticTree<T, Threads, Reclamation>::contains(T value){
+    CriticalSection<decltype(nodes)> critical(nodes);
+
+    int key = hash(value);
+
+    SearchResult result;
+    search(key, result);
+
+    return result.l->key == key;
+}
+
+template<typename T, int Threads, typename Reclamation>
+bool ChromaticTree<T, Threads, Reclamation>::add(T value){
+    CriticalSection<decltype(nodes)> critical(nodes);
+
+    int key = hash(value);
+
+    SearchResult result;
+
+    while(true){
+        search(key, result);
+
+        Node* p = result.p;
+        Node* l = result.l;
+
+        if(l->key == key){
+            return false;
+        }
+
+        Snapshot ps, ls;
+        if(!llx(p, ps) || (ps.left != l && ps.right != l) || !llx(l, ls)){
+            continue;
+        }
+
+        //The leaf is replaced by a node with the new leaf and a copy of the leaf, the weight
+        //of the paths does not change, the root is always black
+        int weight = p == entry ? 1 : l->weight - 1;
+
+        Node* leaf = newNode(key, 1, nullptr, nullptr);
+        Node* sibling = newNode(l->key, 1, nullptr, nullptr);
+        Node* internal = key < l->key ? newNode(l->key, weight, leaf, sibling) : newNode(key, weight, sibling, leaf);
+
+        Info* op = newInfo();
+        addNode(op, p, ps, false);
+        addNode(op, l, ls, true);
+
+        if(scx(op, ps.left == l ? &p->left : &p->right, l, internal)){
+            releaseFinalized(op);
+
+            //A red node under a red node or an overweight leaf replaced by an overweight node
+            if(weight > 1 || (weight == 0 && p->weight == 0)){
+                cleanup(key);
+            }
+
+            return true;
+        }
+
+        releaseNew(internal, leaf, sibling);
+    }
+}
+
+template<typename T, int Threads, typename Reclamation>
+bool ChromaticTree<T, Threads, Reclamation>::remove(T value){
+    CriticalSection<decltype(nodes)> critical(nodes);
+
+    int key = hash(value);
+
+    SearchResult result;
+
+    while(true){
+        search(key, result);
+
+        Node* gp = result.gp;
+        Node* p = result.p;
+        Node* l = result.l;
+
+        //The sentinel leaves, children of the entry, are never removed
+        if(l->key != key || !gp){
+            return false;
+        }
+
+        Snapshot gps, ps;
+        if(!llx(gp, gps) || (gps.left != p && gps.right != p)){
+            continue;
+        }
+
+        if(!llx(p, ps) || (ps.left != l && ps.right != l)){
+            continue;
+        }
+
+        Node* s = ps.left == l ? ps.right : ps.left;
+
+        Snapshot ls, ss;
+        if(!llx(l, ls) || !llx(s, ss)){
+            continue;
+        }
+
+        //The parent and the leaf are replaced by a copy of the sibling holding the weight of the parent
+        int weight = gp == entry ? 1 : p->weight + s->weight;
+
+        Node* replacement = newNode(s->key, weight, ss.left, ss.right);
+
+        Info* op = newInfo();
+        addNode(op, gp, gps, false);
+        addNode(op, p, ps, true);
+        addNode(op, ps.left, ps.left == l ? ls : ss, true);
+        addNode(op, ps.right, ps.right == l ? ls : ss, true);
+
+        if(scx(op, gps.left == p ? &gp->left : &gp->right, p, replacement)){
+            releaseFinalized(op);
+
+            if(weight > 1){
+                cleanup(key);
+            }
+
+            return true;
+        }
+
+        releaseNew(replacement, nullptr);
+    }
+}
+
+template<typename T, int Threads, typename Reclamation>
+OperationState ChromaticTree<T, Threads, Reclamation>::getState(Update update){
+    //The nodes never frozen have an empty word, the sequence numbers start at 1
+    if(getSequence(update) == 0){
+        return FINISHED;
+    }
+
+    unsigned long status = descriptors[getThread(update)].status.load();
+
+    if((status >> 3) != getSequence(update)){
+        return FINISHED;
+    }
+
+    return static_cast<OperationState>(status & 3l);
+}
+
+template<typename T, int Threads, typename Reclamation>
+bool ChromaticTree<T, Threads, Reclamation>::llx(Node* node, Snapshot& snapshot){
+    Update update = node->update;
+    OperationState state = getState(update);
+
+    //A node is frozen while its operation is in progress, and forever once finalized.
+    //A node can only be marked after all the nodes of its operation are frozen, so never by an aborted operation
+    if(state != IN_PROGRESS && !IsMarked(update)){
+        compiler_barrier();
+
+        snapshot.left = node->left;
+        snapshot.right = node->right;
+
+        compiler_barrier();
+
+        //The children are only consistent if the node has not been frozen meanwhile
+        if(node->update == update){
+            snapshot.update = update;
+
+            return true;
+        }
+    }
+
+    update = node->update;
+
+    if(getState(update) == IN_PROGRESS){
+        help(update);
+    }
+
+    return false;
+}
+
+template<typename T, int Threads, typename Reclamation>
+Info* ChromaticTree<T, Threads, Reclamation>::newInfo(){
+    Descriptor& descriptor = descriptors[thread_num];
+
+    //The operations of a thread are over when it starts a new one, only the late helpers can read the descriptor
+    unsigned long sequence = (descriptor.status.load(std::memory_order_relaxed) >> 3) + 1;
+    descriptor.status.store(makeStatus(sequence, IN_PROGRESS), std::memory_order_relaxed);
+
+    //The new sequence number must be visible before the new fields
+    std::atomic_thread_fence(std::memory_order_release);
+
+    Info* op = &descriptor.info;
+    op->update = makeUpdate(thread_num, sequence);
+    op->count = 0;
+    op->finalized = 0;
+
+    return op;
+}
+
+template<typename T, int Threads, typename Reclamation>
+void ChromaticTree<T, Threads, Reclamation>::addNode(Info* op, Node* node, const Snapshot& snapshot, bool finalize){
+    if(finalize){
+        op->finalized |= 1u << op->count;
+    }
+
+    op->nodes[op->count] = node;
+    op->updates[op->count] = snapshot.update;
+    ++op->count;
+}
+
+template<typename T, int Threads, typename Reclamation>
+bool ChromaticTree<T, Threads, Reclamation>::scx(Info* op, Node** field, Node* old, Node* child){
+    op->field = field;
+    op->old = old;
+    op->child = child;
+
+    return help(op);
+}
+
+template<typename T, int Threads, typename Reclamation>
+void ChromaticTree<T, Threads, Reclamation>::help(Update update){
+    Descriptor& descriptor = descriptors[getThread(update)];
+
+    //The operation of another thread is helped from a copy of its descriptor
+    Info op = descriptor.info;
+
+    //The fields must be read before the status, which tells if they belong to the operation
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    unsigned long status = descriptor.status.load(std::memory_order_relaxed);
+
+    //An aborted or committed operation must not be helped anymore
+    if((status >> 3) == getSequence(update) && (status & 3) == IN_PROGRESS){
+        help(&op);
+    }
+}
+
+template<typename T, int Threads, typename Reclamation>
+bool ChromaticTree<T, Threads, Reclamation>::help(Info* op){
+    std::atomic<unsigned long>& status = descriptors[getThread(op->update)].status;
+    unsigned long sequence = getSequence(op->update);
+
+    for(unsigned int i = 0; i < op->count; ++i){
+        Node* node = op->nodes[i];
+
+        if(!CAS(&node->update, op->updates[i], op->update) && Unmark(node->update) != op->update){
+            //The node has changed since it has been read, it can never be frozen by this operation.
+            //Only the helpers coming before all the nodes are frozen can see it
+            unsigned long expected = makeStatus(sequence, IN_PROGRESS);
+            status.compare_exchange_strong(expected, makeStatus(sequence, ABORTED));
+
+            unsigned long current = status.load();
+
+            return (current >> 3) == sequence && (current & ALL_FROZEN);
+        }
+    }
+
+    //The operation can no longer be aborted
+    unsigned long expected = makeStatus(sequence, IN_PROGRESS);
+    status.compare_exchange_strong(expected, makeStatus(sequence, ALL_FROZEN));
+
+    for(unsigned int i = 0; i < op->count; ++i){
+        if(op->finalized & (1u << i)){
+            CAS(&op->nodes[i]->update, op->update, Mark(op->update));
+        }
+    }
+
+    //Once the operation is committed, the old child may be released and reused, a late helper must not swap it again
+    if(status.load() == makeStatus(sequence, ALL_FROZEN)){
+        CASPTR(op->field, op->old, op->child);
+    }
+
+    expected = makeStatus(sequence, ALL_FROZEN);
+    status.compare_exchange_strong(expected, makeStatus(sequence, ALL_FROZEN | COMMITTED));
+
+    return true;
+}
+
+template<typename T, int Threads, typename Reclamation>
+void ChromaticTree<T, Threads, Reclamation>::releaseFinalized(Info* op){
+    for(unsigned int i = 0; i < op->count; ++i){
+        if(op->finalized & (1u << i)){
+            nodes.releaseNode(op->nodes[i]);
+        }
+    }
+}
+
+template<typename T, int Threads, typename Reclamation>
+void ChromaticTree<T, Threads, Reclamation>::releaseNew(Node* top, Node* a, Node* b, Node* c){
+    nodes.releaseNode(top);
+
+    for(Node* node : {a, b, c}){
+        if(node){
+            nodes.releaseNode(node);
+        }
+    }
+}
+
+template<typename T, int Threads, typename Reclamation>
+inline bool ChromaticTree<T, Threads, Reclamation>::isViolation(Node* parent, Node* node){
+    return node->weight > 1 || (node->weight == 0 && parent->weight == 0);
+}
+
+template<typename T, int Threads, typename Reclamation>
+void ChromaticTree<T, Threads, Reclamation>::cleanup(int key){
+    while(true){
+        Node* ggp = nullptr;
+        Node* gp = nullptr;
+        Node* p = entry;
+        Node* l = entry->left;
+
+        //The violation closest to the root is fixed first, so the nodes above it are red or black
+        //and a red node has a black parent. The root is always black, so it is never a violation
+        while(!isViolation(p, l)){
+            if(!l->left){
+                return;
+            }
+
+            ggp = gp;
+            gp = p;
+            p = l;
+
+            l = key < l->key ? l->left : l->right;
+        }
+
+        if(l->weight == 0){
+            fixRed(ggp, gp, p, l);
+        } else {
+            fixOverweight(ggp, gp, p, l);
+        }
+    }
+}
+
+template<typename T, int Threads, typename Reclamation>
+inline Node* ChromaticTree<T, Threads, Reclamation>::copy(Node* node, int weight, const Snapshot& snapshot){
+    return newNode(node->key, weight, snapshot.left, snapshot.right);
+}
+
+template<typename T, int Threads, typename Reclamation>
+inline Node** ChromaticTree<T, Threads, Reclamation>::childField(Node* parent, const Snapshot& snapshot, Node* child){
+    return snapshot.left == child ? &parent->left : &parent->right;
+}
+
+template<typename T, int Threads, typename Reclamation>
+void ChromaticTree<T, Threads, Reclamation>::fixRed(Node* u, Node* g, Node* p, Node* v){
+    //v and p are red, g has changed if it is red too, the violation above is fixed first
+    if(g->weight == 0){
+        return;
+    }
+
+    Snapshot us, gs, ps;
+    if(!llx(u, us) || (us.left != g && us.right != g)){
+        return;
+    }
+
+    if(!llx(g, gs) || (gs.left != p && gs.right != p)){
+        return;
+    }
+
+    if(!llx(p, ps) || (ps.left != v && ps.right != v)){
+        return;
+    }
+
+    bool left = gs.left == p;
+    Node* uncle = left ? gs.right : gs.left;
+
+    //The fourth node replaced by the step, if any
+    Snapshot uncles, vs;
+    if(uncle->weight == 0 ? !llx(uncle, uncles) : (ps.left == v) != left && !llx(v, vs)){
+        return;
+    }
+
+    Info* op = newInfo();
+    addNode(op, u, us, false);
+    addNode(op, g, gs, true);
+    addNode(op, p, ps, true);
+
+    Node* top;
+
+    if(uncle->weight == 0){
+        //Blacken p and its sibling, the weight moves up to g, the root stays black
+        addNode(op, uncle, uncles, true);
+
+        Node* newP = copy(p, 1, ps);
+        Node* newUncle = copy(uncle, 1, uncles);
+        top = newNode(g->key, u == entry ? 1 : g->weight - 1, left ? newP : newUncle, left ? newUncle : newP);
+
+        if(!scx(op, childField(u, us, g), g, top)){
+            releaseNew(top, newP, newUncle);
+            return;
+        }
+    } else if((ps.left == v) == left){
+        //Single rotation, p takes the place of g
+        Node* newG = left ? newNode(g->key, 0, ps.right, uncle) : newNode(g->key, 0, uncle, ps.left);
+        top = left ? newNode(p->key, g->weight, v, newG) : newNode(p->key, g->weight, newG, v);
+
+        if(!scx(op, childField(u, us, g), g, top)){
+            releaseNew(top, newG);
+            return;
+        }
+    } else {
+        //Double rotation, v takes the place of g
+        addNode(op, v, vs, true);
+
+        Node* newP;
+        Node* newG;
+
+        if(left){
+            newP = newNode(p->key, 0, ps.left, vs.left);
+            newG = newNode(g->key, 0, vs.right, uncle);
+            top = newNode(v->key, g->weight, newP, newG);
+        } else {
+            newG = newNode(g->key, 0, uncle, vs.left);
+            newP = newNode(p->key, 0, vs.right, ps.right);
+            top = newNode(v->key, g->weight, newG, newP);
+        }
+
+        if(!scx(op, childField(u, us, g), g, top)){
+            releaseNew(top, newP, newG);
+            return;
+        }
+    }
+
+    releaseFinalized(op);
+}
+
+template<typename T, int Threads, typename Reclamation>
+void ChromaticTree<T, Threads, Reclamation>::fixOverweight(Node* ggp, Node* u, Node* p, Node* v){
+    Snapshot us, ps;
+    if(!llx(u, us) || (us.left != p && us.right != p)){
+        return;
+    }
+
+    if(!llx(p, ps) || (ps.left != v && ps.right != v)){
+        return;
+    }
+
+    bool left = ps.left == v;
+    Node* s = left ? ps.right : ps.left;
+
+    //The root is always black
+    int weight = u == entry ? 1 : p->weight;
+
+    Snapshot ss;
+    if(!llx(s, ss)){
+        return;
+    }
+
+    if(s->weight == 0){
+        if(p->weight == 0){
+            //The red sibling under a red parent is fixed first
+            fixRed(ggp, u, p, s);
+            return;
+        }
+
+        //Rotate the red sibling above p, v then has a black sibling
+        Node* newP;
+        Node* top;
+
+        if(left){
+            newP = newNode(p->key, 0, v, ss.left);
+            top = newNode(s->key, weight, newP, ss.right);
+        } else {
+            newP = newNode(p->key, 0, ss.right, v);
+            top = newNode(s->key, weight, ss.left, newP);
+        }
+
+        Info* op = newInfo();
+        addNode(op, u, us, false);
+        addNode(op, p, ps, true);
+        addNode(op, s, ss, true);
+
+        if(scx(op, childField(u, us, p), p, top)){
+            releaseFinalized(op);
+        } else {
+            releaseNew(top, newP);
+        }
+
+        return;
+    }
+
+    //The weights of the paths through s and v are the same, so s is internal if its weight is 1
+    Node* near = left ? ss.left : ss.right;
+    Node* far = left ? ss.right : ss.left;
+
+    bool push = s->weight > 1 || !near || (near->weight > 0 && far->weight > 0);
+
+    //The red child of s moved by a rotation
+    Snapshot vs, reds;
+    if(!llx(v, vs) || (!push && !llx(far->weight == 0 ? far : near, reds))){
+        return;
+    }
+
+    Info* op = newInfo();
+    addNode(op, u, us, false);
+    addNode(op, p, ps, true);
+    addNode(op, left ? v : s, left ? vs : ss, true);
+    addNode(op, left ? s : v, left ? ss : vs, true);
+
+    Node* newV = copy(v, v->weight - 1, vs);
+
+    if(push){
+        //Push the extra weight of v and a unit of the weight of s to p
+        Node* newS = copy(s, s->weight - 1, ss);
+        Node* top = newNode(p->key, u == entry ? 1 : p->weight + 1, left ? newV : newS, left ? newS : newV);
+
+        if(scx(op, childField(u, us, p), p, top)){
+            releaseFinalized(op);
+        } else {
+            releaseNew(top, newV, newS);
+        }
+    } else if(far->weight == 0){
+        //Single rotation, s takes the place of p and its red far child is blackened
+        addNode(op, far, reds, true);
+
+        Node* newFar = copy(far, 1, reds);
+        Node* newP = left ? newNode(p->key, 1, newV, near) : newNode(p->key, 1, near, newV);
+        Node* top = left ? newNode(s->key, weight, newP, newFar) : newNode(s->key, weight, newFar, newP);
+
+        if(scx(op, childField(u, us, p), p, top)){
+            releaseFinalized(op);
+        } else {
+            releaseNew(top, newV, newP, newFar);
+        }
+    } else {
+        //Double rotation, the red near child of s takes the place of p
+        addNode(op, near, reds, true);
+
+        Node* newP;
+        Node* newS;
+        Node* top;
+
+        if(left){
+            newP = newNode(p->key, 1, newV, reds.left);
+            newS = newNode(s->key, 1, reds.right, far);
+            top = newNode(near->key, weight, newP, newS);
+        } else {
+            newS = newNode(s->key, 1, far, reds.left);
+            newP = newNode(p->key, 1, reds.right, newV);
+            top = newNode(near->key, weight, newS, newP);
+        }
+
+        if(scx(op, childField(u, us, p), p, top)){
+            releaseFinalized(op);
+        } else {
+            releaseNew(top, newV, newP, newS);
+        }
+    }
+}
+
+} //end of chromatic
+
+#endif
@@ -4,11 +4,11 @@
 #include <vector>
 #include <algorithm>
 #include <array>
-#include <unordered_set>
 
 #include "hash.hpp"
 #include "Utils.hpp"
 #include "HazardManager.hpp"
+#include "ThreadRegistry.hpp"
 
 //Lock-Free Multiway Search Tree
 namespace lfmst {
@@ -113,7 +113,7 @@ struct HeadNode {
     int height;
 };
 
-template<typename T, int Threads>
+template<typename T, int Threads, typename Reclamation = HazardPointers>
 class MultiwaySearchTree {
     public:
         MultiwaySearchTree();
@@ -123,19 +123,20 @@ class MultiwaySearchTree {
         bool add(T value);
         bool remove(T value);
 
+        /*!
+         * Return the reclamation counters of all the managers of the structure. 
+         */
+        ReclamationStats reclamation_stats();
+
     private:
         HeadNode* root;
 
-        int randomSeed;
-        
-        HazardManager<HeadNode, Threads, 1, 1> roots;
-        HazardManager<Node, Threads,        4 + MAX> nodes;
-        HazardManager<Contents, Threads,    4 + MAX> nodeContents;
-        HazardManager<Keys, Threads,        4 + MAX> nodeKeys;
-        HazardManager<Children, Threads,    4 + MAX> nodeChildren;
-        HazardManager<Search, Threads,      1> searches;
-
-        std::array<std::vector<Node*>, Threads> trash;
+        typename Reclaimer<Reclamation, HeadNode, Threads, 1, 1>::type roots;
+        typename Reclaimer<Reclamation, Node, Threads,        4 + MAX>::type nodes;
+        typename Reclaimer<Reclamation, Contents, Threads,    4 + MAX>::type nodeContents;
+        typename Reclaimer<Reclamation, Keys, Threads,        4 + MAX>::type nodeKeys;
+        typename Reclaimer<Reclamation, Children, Threads,    4 + MAX>::type nodeChildren;
+        typename Reclaimer<Reclamation, Search, Threads,      1>::type searches;
 
         HeadNode* newHeadNode(Node* node, int height);
         Search* newSearch(Node* node, Contents* contents, int index);
@@ -184,6 +185,11 @@ class MultiwaySearchTree {
 
         unsigned int randomLevel();
         HeadNode* increaseRootHeight(int height);
+
+        /* Critical section on all the managers */
+        friend class CriticalSection<MultiwaySearchTree>;
+        void enter();
+        void exit();
 };
 
 //Values for the random generation
@@ -191,8 +197,8 @@ static const int avgLength = 32;
 static const int avgLengthMinusOne = 31;
 static const int logAvgLength = 5; // log_2 of the average node length
 
-template<typename T, int Threads>
-HeadNode* MultiwaySearchTree<T, Threads>::newHeadNode(Node* node, int height){
+template<typename T, int Threads, typename Reclamation>
+HeadNode* MultiwaySearchTree<T, Threads, Reclamation>::newHeadNode(Node* node, int height){
     HeadNode* root = roots.getFreeNode();
 
     assert(root);
@@ -203,8 +209,8 @@ HeadNode* MultiwaySearchTree<T, Threads>::newHeadNode(Node* node, int height){
     return root;
 }
 
-template<typename T, int Threads>
-Search* MultiwaySearchTree<T, Threads>::newSearch(Node* node, Contents* contents, int index){
+template<typename T, int Threads, typename Reclamation>
+Search* MultiwaySearchTree<T, Threads, Reclamation>::newSearch(Node* node, Contents* contents, int index){
     Search* search = searches.getFreeNode();
 
     assert(search);
@@ -216,8 +222,8 @@ Search* MultiwaySearchTree<T, Threads>::newSearch(Node* node, Contents* contents
     return search;
 }
 
-template<typename T, int Threads>
-Contents* MultiwaySearchTree<T, Threads>::newContents(Keys* items, Children* children, Node* link){
+template<typename T, int Threads, typename Reclamation>
+Contents* MultiwaySearchTree<T, Threads, Reclamation>::newContents(Keys* items, Children* children, Node* link){
     Contents* contents = nodeContents.getFreeNode();
 
     assert(contents);
@@ -229,8 +235,8 @@ Contents* MultiwaySearchTree<T, Threads>::newContents(Keys* items, Children* chi
     return contents;
 }
 
-template<typename T, int Threads>
-Node* MultiwaySearchTree<T, Threads>::newNode(Contents* contents){
+template<typename T, int Threads, typename Reclamation>
+Node* MultiwaySearchTree<T, Threads, Reclamation>::newNode(Contents* contents){
     Node* node = nodes.getFreeNode();
 
     assert(node);
@@ -240,8 +246,8 @@ Node* MultiwaySearchTree<T, Threads>::newNode(Contents* contents){
     return node;
 }
     
-template<typename T, int Threads>
-Keys* MultiwaySearchTree<T, Threads>::newKeys(int length){
+template<typename T, int Threads, typename Reclamation>
+Keys* MultiwaySearchTree<T, Threads, Reclamation>::newKeys(int length){
     Keys* keys = nodeKeys.getFreeNode();
 
     assert(keys);
@@ -260,8 +266,8 @@ Keys* MultiwaySearchTree<T, Threads>::newKeys(int length){
     return keys;
 }
 
-template<typename T, int Threads>
-Children* MultiwaySearchTree<T, Threads>::newChildren(int length){
+template<typename T, int Threads, typename Reclamation>
+Children* MultiwaySearchTree<T, Threads, Reclamation>::newChildren(int length){
     Children* children = nodeChildren.getFreeNode();
 
     assert(children);
@@ -293,8 +299,8 @@ Key special_hash(T value){
     return {KeyFlag::NORMAL, key};
 }
 
-template<typename T, int Threads>
-MultiwaySearchTree<T, Threads>::MultiwaySearchTree(){
+template<typename T, int Threads, typename Reclamation>
+MultiwaySearchTree<T, Threads, Reclamation>::MultiwaySearchTree(){
     Keys* keys = newKeys(1);
     (*keys)[0] = {KeyFlag::INF, 0};
 
@@ -302,103 +308,50 @@ MultiwaySearchTree<T, Threads>::MultiwaySearchTree(){
     Node* node = newNode(contents);
 
     root = newHeadNode(node, 0);
-    
-    std::mt19937_64 engine(time(NULL));
-    std::uniform_int_distribution<unsigned int> distribution(0, std::numeric_limits<int>::max());
-    randomSeed = distribution(engine) | 0x0100;
 }
 
-template<typename Node>
-inline void transfer(std::list<Node*>& source, std::unordered_set<Node*>& target){
-    for(auto j : source){
-        target.insert(j);
-    }
-    source.clear();
+template<typename T, int Threads, typename Reclamation>
+MultiwaySearchTree<T, Threads, Reclamation>::~MultiwaySearchTree(){
+    //Nothing to release: every node, contents, keys and children (even the ones still 
+    //in the tree or the ones pushed out of it) is destroyed with the arenas of the managers
 }
 
-template<typename HP, typename Node>
-inline void release_all(std::unordered_set<Node*>& nodes, HP& hazard){
-    auto nodes_it = nodes.begin();
-    auto nodes_end = nodes.end();
-
-    while(nodes_it != nodes_end){
-        hazard.releaseNode(*nodes_it);
+template<typename T, int Threads, typename Reclamation>
+ReclamationStats MultiwaySearchTree<T, Threads, Reclamation>::reclamation_stats(){
+    ReclamationStats stats = roots.stats();
+    stats += nodes.stats();
+    stats += nodeContents.stats();
+    stats += nodeKeys.stats();
+    stats += nodeChildren.stats();
+    stats += searches.stats();
 
-        ++nodes_it;
-    }
+    return stats;
 }
 
-template<typename T, int Threads>
-MultiwaySearchTree<T, Threads>::~MultiwaySearchTree(){
-    std::unordered_set<Node*> set_nodes;
-    std::unordered_set<Keys*> set_keys;
-    std::unordered_set<Contents*> set_contents;
-    std::unordered_set<Children*> set_children;
-    
-    //Get the trashed nodes
-    for(unsigned int i = 0; i < Threads; ++i){
-        auto it = trash[i].begin();
-        auto end = trash[i].end();
-
-        while(it != end){
-            set_nodes.insert(*it);
-
-            ++it;
-        }
-    }
-
-    roots.releaseNode(root);
-    
-    std::vector<Node*> stack;
-    stack.push_back(root->node);
-
-    while(stack.size() > 0){
-        Node* n = stack.back();
-        stack.pop_back();
-
-        if(n->contents){
-            if(n->contents->items){
-                set_keys.insert(n->contents->items);
-            }
-
-            if(n->contents->children){
-                for(int i = 0; i < n->contents->children->length; ++i){
-                    stack.push_back((*n->contents->children)[i]);
-                }
-
-                set_children.insert(n->contents->children);
-            }
-
-            set_contents.insert(n->contents);
-
-            n->contents = nullptr;
-        }
-
-        set_nodes.insert(n);
-    }
-
-    for(unsigned int i = 0; i < Threads; ++i){
-        transfer(nodes.direct_free(i), set_nodes);
-        transfer(nodes.direct_local(i), set_nodes);
-        
-        transfer(nodeContents.direct_free(i), set_contents);
-        transfer(nodeContents.direct_local(i), set_contents);
-        
-        transfer(nodeKeys.direct_free(i), set_keys);
-        transfer(nodeKeys.direct_local(i), set_keys);
-        
-        transfer(nodeChildren.direct_free(i), set_children);
-        transfer(nodeChildren.direct_local(i), set_children);
-    }
+template<typename T, int Threads, typename Reclamation>
+void MultiwaySearchTree<T, Threads, Reclamation>::enter(){
+    roots.enter();
+    nodes.enter();
+    nodeContents.enter();
+    nodeKeys.enter();
+    nodeChildren.enter();
+    searches.enter();
+}
 
-    release_all(set_nodes, nodes);
-    release_all(set_keys, nodeKeys);
-    release_all(set_contents, nodeContents);
-    release_all(set_children, nodeChildren);
+template<typename T, int Threads, typename Reclamation>
+void MultiwaySearchTree<T, Threads, Reclamation>::exit(){
+    searches.exit();
+    nodeChildren.exit();
+    nodeKeys.exit();
+    nodeContents.exit();
+    nodes.exit();
+    roots.exit();
 }
 
-template<typename T, int Threads>
-bool MultiwaySearchTree<T, Threads>::contains(T value){
+template<typename T, int Threads, typename Reclamation>
+bool MultiwaySearchTree<T, Threads, Reclamation>::contains(T value){
+    CriticalSection<MultiwaySearchTree> critical(*this);
+
     Key key = special_hash(value);
 
     Node* node = this->root->node;
@@ -452,8 +405,10 @@ bool MultiwaySearchTree<T, Threads>::contains(T value){
     }
 }
 
-template<typename T, int Threads>
-bool MultiwaySearchTree<T, Threads>::add(T value){
+template<typename T, int Threads, typename Reclamation>
+bool MultiwaySearchTree<T, Threads, Reclamation>::add(T value){
+    CriticalSection<MultiwaySearchTree> critical(*this);
+
     Key key = special_hash(value);
 
     unsigned int height = randomLevel();
@@ -528,8 +483,8 @@ bool MultiwaySearchTree<T, Threads>::add(T value){
     }
 }
         
-template<typename T, int Threads>
-Search* MultiwaySearchTree<T, Threads>::traverseLeaf(Key key, bool cleanup){
+template<typename T, int Threads, typename Reclamation>
+Search* MultiwaySearchTree<T, Threads, Reclamation>::traverseLeaf(Key key, bool cleanup){
     Node* node = this->root->node;
     nodes.publish(node, 0);
 
@@ -599,8 +554,8 @@ Search* MultiwaySearchTree<T, Threads>::traverseLeaf(Key key, bool cleanup){
     }
 }
 
-template<typename T, int Threads>
-void MultiwaySearchTree<T, Threads>::traverseNonLeaf(Key key, int target, Search** storeResults){
+template<typename T, int Threads, typename Reclamation>
+void MultiwaySearchTree<T, Threads, Reclamation>::traverseNonLeaf(Key key, int target, Search** storeResults){
     HeadNode* root = this->root;
 
     if(root->height < target){
@@ -676,8 +631,10 @@ void MultiwaySearchTree<T, Threads>::traverseNonLeaf(Key key, int target, Search
     }
 }
 
-template<typename T, int Threads>
-bool MultiwaySearchTree<T, Threads>::remove(T value){
+template<typename T, int Threads, typename Reclamation>
+bool MultiwaySearchTree<T, Threads, Reclamation>::remove(T value){
+    CriticalSection<MultiwaySearchTree> critical(*this);
+
     Key key = special_hash(value);
 
     Search* results = traverseLeaf(key, true);
@@ -695,8 +652,8 @@ bool MultiwaySearchTree<T, Threads>::remove(T value){
     return removed;
 }
 
-template<typename T, int Threads>
-bool MultiwaySearchTree<T, Threads>::removeFromNode(Key key, Search* results){
+template<typename T, int Threads, typename Reclamation>
+bool MultiwaySearchTree<T, Threads, Reclamation>::removeFromNode(Key key, Search* results){
     while(true){
         Node* node = results->node;
         Contents* contents = results->contents;
@@ -750,8 +707,8 @@ bool MultiwaySearchTree<T, Threads>::removeFromNode(Key key, Search* results){
 }
 
 //node must be published by parent
-template<typename T, int Threads>
-Contents* MultiwaySearchTree<T, Threads>::cleanLink(Node* node, Contents* contents){
+template<typename T, int Threads, typename Reclamation>
+Contents* MultiwaySearchTree<T, Threads, Reclamation>::cleanLink(Node* node, Contents* contents){
     while(true){
         nodeContents.publish(contents, 1);
         
@@ -802,8 +759,8 @@ int compare(Key k1, Key k2){
 }
 
 //node must be published by parent
-template<typename T, int Threads>
-void MultiwaySearchTree<T, Threads>::cleanNode(Key key, Node* node, Contents* contents, int index, Key leftBarrier){
+template<typename T, int Threads, typename Reclamation>
+void MultiwaySearchTree<T, Threads, Reclamation>::cleanNode(Key key, Node* node, Contents* contents, int index, Key leftBarrier){
     while(true){
         nodeContents.publish(contents, 1);
         nodeKeys.publish(contents->items, 1);
@@ -861,8 +818,8 @@ void MultiwaySearchTree<T, Threads>::cleanNode(Key key, Node* node, Contents* co
 //contents must be published
 //contents->items must be published
 //contents->children must be published
-template<typename T, int Threads>
-bool MultiwaySearchTree<T, Threads>::cleanNode1(Node* node, Contents* contents, Key leftBarrier){
+template<typename T, int Threads, typename Reclamation>
+bool MultiwaySearchTree<T, Threads, Reclamation>::cleanNode1(Node* node, Contents* contents, Key leftBarrier){
     bool success = attemptSlideKey(node, contents);
 
     if(success){
@@ -890,8 +847,8 @@ bool MultiwaySearchTree<T, Threads>::cleanNode1(Node* node, Contents* contents,
 //contents must be published by parent
 //contents->items must be published
 //contents->children must be published
-template<typename T, int Threads>
-bool MultiwaySearchTree<T, Threads>::cleanNode2(Node* node, Contents* contents, Key leftBarrier){
+template<typename T, int Threads, typename Reclamation>
+bool MultiwaySearchTree<T, Threads, Reclamation>::cleanNode2(Node* node, Contents* contents, Key leftBarrier){
     bool success = attemptSlideKey(node, contents);
 
     if(success){
@@ -922,8 +879,8 @@ bool MultiwaySearchTree<T, Threads>::cleanNode2(Node* node, Contents* contents,
 //contents must be published by parent
 //contents->items must be published
 //contents->children must be published
-template<typename T, int Threads>
-bool MultiwaySearchTree<T, Threads>::cleanNodeN(Node* node, Contents* contents, int index, Key leftBarrier){
+template<typename T, int Threads, typename Reclamation>
+bool MultiwaySearchTree<T, Threads, Reclamation>::cleanNodeN(Node* node, Contents* contents, int index, Key leftBarrier){
     Key key0 = (*contents->items)[0];
 
     if(index > 0){
@@ -955,8 +912,8 @@ bool MultiwaySearchTree<T, Threads>::cleanNodeN(Node* node, Contents* contents,
     }
 }
 
-template<typename T, int Threads>
-Node* MultiwaySearchTree<T, Threads>::pushRight(Node* node, Key leftBarrier){
+template<typename T, int Threads, typename Reclamation>
+Node* MultiwaySearchTree<T, Threads, Reclamation>::pushRight(Node* node, Key leftBarrier){
     while(true){
         nodes.publish(node, 0);
 
@@ -969,7 +926,6 @@ Node* MultiwaySearchTree<T, Threads>::pushRight(Node* node, Key leftBarrier){
         if(length == 0){
             //It is a good idea to release contents->link afterward
             node = contents->link;
-            trash[thread_num].push_back(node);
         } else if(leftBarrier.flag == KeyFlag::EMPTY || compare((*contents->items)[length - 1], leftBarrier) > 0){
             nodeContents.release(2);
             nodeKeys.release(2);
@@ -983,19 +939,14 @@ Node* MultiwaySearchTree<T, Threads>::pushRight(Node* node, Key leftBarrier){
     }
 }
 
-template<typename T, int Threads>
-unsigned int MultiwaySearchTree<T, Threads>::randomLevel(){
-    unsigned int x = randomSeed;
-    x ^= x << 13;
-    x ^= x >> 17;
-    randomSeed = x ^= x << 5;
+template<typename T, int Threads, typename Reclamation>
+unsigned int MultiwaySearchTree<T, Threads, Reclamation>::randomLevel(){
+    //The generator of the calling thread, a shared seed would be written by all the threads
+    unsigned int x = thread_random();
     unsigned int level = 1;
     while ((x & avgLengthMinusOne) == 0) {
         if ((level % 6) == 0) {
-            x = randomSeed;
-            x ^= x << 13;
-            x ^= x >> 17;
-            randomSeed = x ^= x << 5;
+            x = thread_random();
         } else {
             x >>= logAvgLength;
         }
@@ -1074,8 +1025,8 @@ int searchWithHint(Keys* items, Key key, int hint){
     return -(low + 1); //not found
 }
 
-template<typename T, int Threads>
-HeadNode* MultiwaySearchTree<T, Threads>::increaseRootHeight(int target){
+template<typename T, int Threads, typename Reclamation>
+HeadNode* MultiwaySearchTree<T, Threads, Reclamation>::increaseRootHeight(int target){
     HeadNode* root = this->root;
     roots.publish(root, 0);
     nodes.publish(root->node, 0);
@@ -1117,8 +1068,8 @@ HeadNode* MultiwaySearchTree<T, Threads>::increaseRootHeight(int target){
 }
 
 //node must be published by parent as 0
-template<typename T, int Threads>
-Search* MultiwaySearchTree<T, Threads>::moveForward(Node* node, Key key, int hint){
+template<typename T, int Threads, typename Reclamation>
+Search* MultiwaySearchTree<T, Threads, Reclamation>::moveForward(Node* node, Key key, int hint){
     while(true){
         Contents* contents = node->contents;
         nodeContents.publish(contents, 1);
@@ -1143,8 +1094,8 @@ Search* MultiwaySearchTree<T, Threads>::moveForward(Node* node, Key key, int hin
 //contents must be published by parent
 //contents->items must be published
 //contents->children must be published
-template<typename T, int Threads>
-bool MultiwaySearchTree<T, Threads>::shiftChild(Node* node, Contents* contents, int index, Node* adjustedChild){
+template<typename T, int Threads, typename Reclamation>
+bool MultiwaySearchTree<T, Threads, Reclamation>::shiftChild(Node* node, Contents* contents, int index, Node* adjustedChild){
     Children* children = copyChildren(contents->children);
     (*children)[index] = adjustedChild;
 
@@ -1166,8 +1117,8 @@ bool MultiwaySearchTree<T, Threads>::shiftChild(Node* node, Contents* contents,
 //contents must be published by parent
 //contents->items must be published
 //contents->children must be published
-template<typename T, int Threads>
-bool MultiwaySearchTree<T, Threads>::shiftChildren(Node* node, Contents* contents, Node* child1, Node* child2){
+template<typename T, int Threads, typename Reclamation>
+bool MultiwaySearchTree<T, Threads, Reclamation>::shiftChildren(Node* node, Contents* contents, Node* child1, Node* child2){
     Children* children = newChildren(2);
     (*children)[0] = child1;
     (*children)[1] = child2;
@@ -1190,8 +1141,8 @@ bool MultiwaySearchTree<T, Threads>::shiftChildren(Node* node, Contents* content
 //contents must be published by parent
 //contents->children must be published
 //contents->item must be published
-template<typename T, int Threads>
-bool MultiwaySearchTree<T, Threads>::dropChild(Node* node, Contents* contents, int index, Node* adjustedChild){
+template<typename T, int Threads, typename Reclamation>
+bool MultiwaySearchTree<T, Threads, Reclamation>::dropChild(Node* node, Contents* contents, int index, Node* adjustedChild){
     int length = contents->items->length;
 
     Keys* keys = newKeys(length - 1);
@@ -1232,8 +1183,8 @@ bool MultiwaySearchTree<T, Threads>::dropChild(Node* node, Contents* contents, i
 //contents is published by parent
 //contents->items is published
 //contents->children is published
-template<typename T, int Threads>
-bool MultiwaySearchTree<T, Threads>::attemptSlideKey(Node* node, Contents* contents){
+template<typename T, int Threads, typename Reclamation>
+bool MultiwaySearchTree<T, Threads, Reclamation>::attemptSlideKey(Node* node, Contents* contents){
     if(!contents->link){
         return false;
     }
@@ -1310,8 +1261,8 @@ bool MultiwaySearchTree<T, Threads>::attemptSlideKey(Node* node, Contents* conte
 //sibContents is published by parent
 //sibContents->items is published
 //sibContents->children is published
-template<typename T, int Threads>
-bool MultiwaySearchTree<T, Threads>::slideToNeighbor(Node* sibling, Contents* sibContents, Key kkey, Key key, Node* child){
+template<typename T, int Threads, typename Reclamation>
+bool MultiwaySearchTree<T, Threads, Reclamation>::slideToNeighbor(Node* sibling, Contents* sibContents, Key kkey, Key key, Node* child){
     int index = search(sibContents->items, key);
     if(index >= 0){
         return true;
@@ -1342,8 +1293,8 @@ bool MultiwaySearchTree<T, Threads>::slideToNeighbor(Node* sibling, Contents* si
 //contents is published
 //contents->items is published
 //contents->children is published
-template<typename T, int Threads>
-Contents* MultiwaySearchTree<T, Threads>::deleteSlidedKey(Node* node, Contents* contents, Key key){
+template<typename T, int Threads, typename Reclamation>
+Contents* MultiwaySearchTree<T, Threads, Reclamation>::deleteSlidedKey(Node* node, Contents* contents, Key key){
     int index = search(contents->items, key);
     if(index < 0){
         return contents;
@@ -1370,8 +1321,8 @@ Contents* MultiwaySearchTree<T, Threads>::deleteSlidedKey(Node* node, Contents*
     }
 }
 
-template<typename T, int Threads>
-Search* MultiwaySearchTree<T, Threads>::goodSamaritanCleanNeighbor(Key key, Search* results){
+template<typename T, int Threads, typename Reclamation>
+Search* MultiwaySearchTree<T, Threads, Reclamation>::goodSamaritanCleanNeighbor(Key key, Search* results){
     Node* node = results->node;
     nodes.publish(node, 1);
     
@@ -1476,8 +1427,8 @@ Search* MultiwaySearchTree<T, Threads>::goodSamaritanCleanNeighbor(Key key, Sear
     return results;
 }
 
-template<typename T, int Threads>
-Node* MultiwaySearchTree<T, Threads>::splitOneLevel(Key key, Search* results){
+template<typename T, int Threads, typename Reclamation>
+Node* MultiwaySearchTree<T, Threads, Reclamation>::splitOneLevel(Key key, Search* results){
     Search* entry_results = results;
 
     while(true){
@@ -1564,8 +1515,8 @@ Node* MultiwaySearchTree<T, Threads>::splitOneLevel(Key key, Search* results){
     }
 }
 
-template<typename T, int Threads>
-char MultiwaySearchTree<T, Threads>::insertLeafLevel(Key key, Search* results, int back){
+template<typename T, int Threads, typename Reclamation>
+char MultiwaySearchTree<T, Threads, Reclamation>::insertLeafLevel(Key key, Search* results, int back){
     int back_length = back;
 
     while(true){
@@ -1632,8 +1583,8 @@ char MultiwaySearchTree<T, Threads>::insertLeafLevel(Key key, Search* results, i
     }
 }
 
-template<typename T, int Threads>
-bool MultiwaySearchTree<T, Threads>::beginInsertOneLevel(Key key, Search** resultsStore){
+template<typename T, int Threads, typename Reclamation>
+bool MultiwaySearchTree<T, Threads, Reclamation>::beginInsertOneLevel(Key key, Search** resultsStore){
     Search* results = resultsStore[0];
 
     while(true){
@@ -1702,8 +1653,8 @@ bool MultiwaySearchTree<T, Threads>::beginInsertOneLevel(Key key, Search** resul
     }
 }
 
-template<typename T, int Threads>
-void MultiwaySearchTree<T, Threads>::insertOneLevel(Key key, Search** resultsStore, Node* child, int target){
+template<typename T, int Threads, typename Reclamation>
+void MultiwaySearchTree<T, Threads, Reclamation>::insertOneLevel(Key key, Search** resultsStore, Node* child, int target){
     if(!child){
         return;
     }
@@ -1793,8 +1744,8 @@ void MultiwaySearchTree<T, Threads>::insertOneLevel(Key key, Search** resultsSto
 
 /* Utility methods to manipulate arrays */
 
-template<typename T, int Threads>
-Children* MultiwaySearchTree<T, Threads>::copyChildren(Children* rhs){
+template<typename T, int Threads, typename Reclamation>
+Children* MultiwaySearchTree<T, Threads, Reclamation>::copyChildren(Children* rhs){
     Children* copy = newChildren(rhs->length);
     
     for(int i = 0; i < copy->length; ++i){
@@ -1804,8 +1755,8 @@ Children* MultiwaySearchTree<T, Threads>::copyChildren(Children* rhs){
     return copy;
 }
 
-template<typename T, int Threads>
-Keys* MultiwaySearchTree<T, Threads>::removeSingleItem(Keys* a, int index){
+template<typename T, int Threads, typename Reclamation>
+Keys* MultiwaySearchTree<T, Threads, Reclamation>::removeSingleItem(Keys* a, int index){
     int length = a->length;
     Keys* newArray = newKeys(length - 1);
 
@@ -1820,8 +1771,8 @@ Keys* MultiwaySearchTree<T, Threads>::removeSingleItem(Keys* a, int index){
     return newArray;
 }
 
-template<typename T, int Threads>
-Children* MultiwaySearchTree<T, Threads>::removeSingleItem(Children* a, int index){
+template<typename T, int Threads, typename Reclamation>
+Children* MultiwaySearchTree<T, Threads, Reclamation>::removeSingleItem(Children* a, int index){
     int length = a->length;
     Children* newArray = newChildren(length - 1);
 
@@ -1836,8 +1787,8 @@ Children* MultiwaySearchTree<T, Threads>::removeSingleItem(Children* a, int inde
     return newArray;
 }
 
-template<typename T, int Threads>
-Keys* MultiwaySearchTree<T, Threads>::generateNewItems(Key key, Keys* items, int index){
+template<typename T, int Threads, typename Reclamation>
+Keys* MultiwaySearchTree<T, Threads, Reclamation>::generateNewItems(Key key, Keys* items, int index){
     if(!items){
         return nullptr;
     }
@@ -1856,8 +1807,8 @@ Keys* MultiwaySearchTree<T, Threads>::generateNewItems(Key key, Keys* items, int
     return newItems;
 }
 
-template<typename T, int Threads>
-Children* MultiwaySearchTree<T, Threads>::generateNewChildren(Node* child, Children* children, int index){
+template<typename T, int Threads, typename Reclamation>
+Children* MultiwaySearchTree<T, Threads, Reclamation>::generateNewChildren(Node* child, Children* children, int index){
     if(!children){
         return nullptr;
     }
@@ -1876,8 +1827,8 @@ Children* MultiwaySearchTree<T, Threads>::generateNewChildren(Node* child, Child
     return newItems;
 }
 
-template<typename T, int Threads>
-Keys* MultiwaySearchTree<T, Threads>::generateLeftItems(Keys* items, int index){
+template<typename T, int Threads, typename Reclamation>
+Keys* MultiwaySearchTree<T, Threads, Reclamation>::generateLeftItems(Keys* items, int index){
     if(!items){
         return nullptr;
     }
@@ -1891,8 +1842,8 @@ Keys* MultiwaySearchTree<T, Threads>::generateLeftItems(Keys* items, int index){
     return newItems;
 }
 
-template<typename T, int Threads>
-Keys* MultiwaySearchTree<T, Threads>::generateRightItems(Keys* items, int index){
+template<typename T, int Threads, typename Reclamation>
+Keys* MultiwaySearchTree<T, Threads, Reclamation>::generateRightItems(Keys* items, int index){
     if(!items){
         return nullptr;
     }
@@ -1906,8 +1857,8 @@ Keys* MultiwaySearchTree<T, Threads>::generateRightItems(Keys* items, int index)
 
     return newItems;
 }
-template<typename T, int Threads>
-Children* MultiwaySearchTree<T, Threads>::generateLeftChildren(Children* children, int index){
+template<typename T, int Threads, typename Reclamation>
+Children* MultiwaySearchTree<T, Threads, Reclamation>::generateLeftChildren(Children* children, int index){
     if(!children){
         return nullptr;
     }
@@ -1921,8 +1872,8 @@ Children* MultiwaySearchTree<T, Threads>::generateLeftChildren(Children* childre
     return newItems;
 }
 
-template<typename T, int Threads>
-Children* MultiwaySearchTree<T, Threads>::generateRightChildren(Children* children, int index){
+template<typename T, int Threads, typename Reclamation>
+Children* MultiwaySearchTree<T, Threads, Reclamation>::generateRightChildren(Children* children, int index){
     if(!children){
         return nullptr;
     }
@@ -2,9 +2,12 @@
 #define NBBST_TREE
 
 #include <cassert>
+#include <atomic>
 
 #include "hash.hpp"
 #include "Utils.hpp"
+#include "HazardManager.hpp"
+#include "ThreadRegistry.hpp"
 
 namespace nbbst {
     
@@ -16,56 +19,110 @@ enum UpdateState {
 };
 
 struct Node;
+struct Leaf;
 
-struct Info;
-typedef Info* Update;
+/*!
+ * An update word: the state in the two lowest bits, then the slot of the thread whose descriptor 
+ * describes the operation and the sequence number of the operation in this thread. The sequence 
+ * numbers only grow, so a word is never seen twice, even if the descriptors are reused. 
+ */
+typedef unsigned long Update;
 
-struct Info {
-    Node* gp;               //Internal
-    Node* p;                //Internal
-    Node* newInternal;      //Internal
-    Node* l;                //Leaf
-    Update pupdate;
+static const unsigned int ThreadBits = 16;
 
-    Info() : gp(nullptr), p(nullptr), newInternal(nullptr), l(nullptr), pupdate(nullptr) {}
-};
+inline UpdateState getState(Update update){
+   return static_cast<UpdateState>(update & 3l);
+}
 
-typedef Info* Update; 
+inline Update Unmark(Update update){
+    return update & (~0l - 3);
+}
 
-inline UpdateState getState(Update update){
-   return static_cast<UpdateState>(reinterpret_cast<unsigned long>(update) & 3l);
+inline Update Mark(Update update, UpdateState state){
+    return Unmark(update) | static_cast<unsigned int>(state);
 }
 
-inline Update Unmark(Update info){
-    return reinterpret_cast<Update>(reinterpret_cast<unsigned long>(info) & (~0l - 3));
+inline Update makeUpdate(unsigned int thread, unsigned long sequence){
+    return (sequence << (ThreadBits + 2)) | (static_cast<unsigned long>(thread) << 2);
 }
 
-inline Update Mark(Update info, UpdateState state){
-    return reinterpret_cast<Update>((reinterpret_cast<unsigned long>(info) & (~0l - 3)) | static_cast<unsigned int>(state));
+inline unsigned int getThread(Update update){
+    return (update >> 2) & ((1ul << ThreadBits) - 1);
 }
 
+inline unsigned long getSequence(Update update){
+    return update >> (ThreadBits + 2);
+}
+
+struct Info {
+    Node* gp;
+    Node* p;
+    Node* newInternal;
+    Leaf* l;
+    Update pupdate;
+    Update update;          //The word of the operation, in the CLEAN state
+
+    Info() : gp(nullptr), p(nullptr), newInternal(nullptr), l(nullptr), pupdate(0), update(0) {}
+};
+
+/*!
+ * The descriptor of a thread, reused by all its operations instead of allocating an Info for each 
+ * of them. Before the fields are written for a new operation, the sequence number is incremented, 
+ * so a helper reading the fields of a previous operation sees that it is over. 
+ */
+struct Descriptor {
+    std::atomic<unsigned long> sequence;
+    Info info;
+};
+
+/*!
+ * A leaf only holds its key, half the nodes of the tree are leaves. 
+ */
+struct Leaf {
+    int key;
+};
+
+/*!
+ * An internal node. The children pointing to a leaf have their lowest bit set, so that 
+ * a search knows it has reached a leaf without reading it. 
+ */
 struct Node {
-    bool internal;
     int key;
     
     Update update;
     Node* left;
     Node* right;
 
-    Node() : internal(internal), key(key), update(nullptr), left(nullptr), right(nullptr) {};
+    Node() : update(0), left(nullptr), right(nullptr) {};
 };
 
+inline bool IsLeaf(Node* child){
+    return reinterpret_cast<unsigned long>(child) & 0x1;
+}
+
+inline Node* TagLeaf(Leaf* leaf){
+    return reinterpret_cast<Node*>(reinterpret_cast<unsigned long>(leaf) | 0x1);
+}
+
+inline Leaf* AsLeaf(Node* child){
+    return reinterpret_cast<Leaf*>(reinterpret_cast<unsigned long>(child) & (~0l - 1));
+}
+
+inline int getKey(Node* child){
+    return IsLeaf(child) ? AsLeaf(child)->key : child->key;
+}
+
 struct SearchResult {
-    Node* gp;       //Internal
-    Node* p;        //Internal
-    Node* l;        //Leaf
+    Node* gp;
+    Node* p;
+    Leaf* l;
     Update pupdate;
     Update gpupdate;
 
-    SearchResult() : gp(nullptr), p(nullptr), l(nullptr), pupdate(nullptr), gpupdate(nullptr) {}
+    SearchResult() : gp(nullptr), p(nullptr), l(nullptr), pupdate(0), gpupdate(0) {}
 };
 
-template<typename T, int Threads>
+template<typename T, int Threads, typename Reclamation = HazardPointers>
 class NBBST {
     public:
         NBBST();
@@ -75,6 +132,11 @@ class NBBST {
         bool add(T value);
         bool remove(T value);
 
+        /*!
+         * Return the reclamation counters of all the managers of the structure. 
+         */
+        ReclamationStats reclamation_stats();
+
     private:
         void Search(int key, SearchResult* result);      
         void HelpInsert(Info* op);
@@ -83,61 +145,96 @@ class NBBST {
         void Help(Update u);
         void CASChild(Node* parent, Node* old, Node* newNode);
 
-        /* Allocate stuff from the hazard manager  */
+        /* Allocate stuff from the hazard managers  */
         Node* newInternal(int key);
-        Node* newLeaf(int key);
-        Info* newIInfo(Node* p, Node* newInternal, Node* l);
-        Info* newDInfo(Node* gp, Node* p, Node* l, Update pupdate);
+        Leaf* newLeaf(int key);
+
+        /* Prepare the descriptor of the calling thread for a new operation */
+        Info* newInfo();
+        Info* newIInfo(Node* p, Node* newInternal, Leaf* l);
+        Info* newDInfo(Node* gp, Node* p, Leaf* l, Update pupdate);
+
+        /*!
+         * Copy the fields of the operation of the update word. 
+         * \return false if the descriptor already describes a later operation, the operation is then over. 
+         */
+        bool readInfo(Update update, Info& info);
         
-        /* To remove properly a node  */
-        void releaseNode(Node* node);
+        /* To publish and remove properly a child, leaf or internal node */
+        void publish(Node* child, unsigned int i);
+        void releaseAll();
+        void releaseChild(Node* child);
 
         Node* root;
 
-        HazardManager<Node, Threads, 3> nodes;
-        HazardManager<Info, Threads, 3> infos;
+        typename Reclaimer<Reclamation, Node, Threads, 3>::type nodes;
+        typename Reclaimer<Reclamation, Leaf, Threads, 3>::type leaves;
+
+        ThreadTable<Descriptor> descriptors;
 };
 
-template<typename T, int Threads>
-NBBST<T, Threads>::NBBST(){
+template<typename T, int Threads, typename Reclamation>
+NBBST<T, Threads, Reclamation>::NBBST() : descriptors(Threads) {
     root = newInternal(std::numeric_limits<int>::max());
-    root->update = Mark(nullptr, CLEAN);
+    root->update = Mark(0, CLEAN);
 
-    root->left = newLeaf(std::numeric_limits<int>::min());
-    root->right = newLeaf(std::numeric_limits<int>::max());
+    root->left = TagLeaf(newLeaf(std::numeric_limits<int>::min()));
+    root->right = TagLeaf(newLeaf(std::numeric_limits<int>::max()));
 }
 
-template<typename T, int Threads>
-NBBST<T, Threads>::~NBBST(){
+template<typename T, int Threads, typename Reclamation>
+NBBST<T, Threads, Reclamation>::~NBBST(){
     //Remove the three nodes created in the constructor
-    releaseNode(root->left);
-    releaseNode(root->right);
-    releaseNode(root);
+    releaseChild(root->left);
+    releaseChild(root->right);
+    releaseChild(root);
 }
 
-template<typename T, int Threads>
-Node* NBBST<T, Threads>::newInternal(int key){
+template<typename T, int Threads, typename Reclamation>
+ReclamationStats NBBST<T, Threads, Reclamation>::reclamation_stats(){
+    ReclamationStats stats = nodes.stats();
+    stats += leaves.stats();
+
+    return stats;
+}
+
+template<typename T, int Threads, typename Reclamation>
+Node* NBBST<T, Threads, Reclamation>::newInternal(int key){
     Node* node = nodes.getFreeNode();
 
-    node->internal = true;
     node->key = key;
 
     return node;
 }
 
-template<typename T, int Threads>
-Node* NBBST<T, Threads>::newLeaf(int key){
-    Node* node = nodes.getFreeNode();
+template<typename T, int Threads, typename Reclamation>
+Leaf* NBBST<T, Threads, Reclamation>::newLeaf(int key){
+    Leaf* leaf = leaves.getFreeNode();
 
-    node->internal = false;
-    node->key = key;
+    leaf->key = key;
 
-    return node;
+    return leaf;
 }
         
-template<typename T, int Threads>
-Info* NBBST<T, Threads>::newIInfo(Node* p, Node* newInternal, Node* l){
-    Info* info = infos.getFreeNode();
+template<typename T, int Threads, typename Reclamation>
+Info* NBBST<T, Threads, Reclamation>::newInfo(){
+    Descriptor& descriptor = descriptors[thread_num];
+
+    //The operations of a thread are over when it starts a new one, only the late helpers can read the descriptor
+    unsigned long sequence = descriptor.sequence.load(std::memory_order_relaxed) + 1;
+    descriptor.sequence.store(sequence, std::memory_order_relaxed);
+
+    //The new sequence number must be visible before the new fields
+    std::atomic_thread_fence(std::memory_order_release);
+
+    descriptor.info.update = makeUpdate(thread_num, sequence);
+
+    return &descriptor.info;
+}
+
+template<typename T, int Threads, typename Reclamation>
+Info* NBBST<T, Threads, Reclamation>::newIInfo(Node* p, Node* newInternal, Leaf* l){
+    Info* info = newInfo();
 
     info->p = p;
     info->newInternal = newInternal;
@@ -146,9 +243,9 @@ Info* NBBST<T, Threads>::newIInfo(Node* p, Node* newInternal, Node* l){
     return info;
 }
 
-template<typename T, int Threads>
-Info* NBBST<T, Threads>::newDInfo(Node* gp, Node* p, Node* l, Update pupdate){
-    Info* info = infos.getFreeNode();
+template<typename T, int Threads, typename Reclamation>
+Info* NBBST<T, Threads, Reclamation>::newDInfo(Node* gp, Node* p, Leaf* l, Update pupdate){
+    Info* info = newInfo();
 
     info->gp = gp;
     info->p = p;
@@ -158,22 +255,47 @@ Info* NBBST<T, Threads>::newDInfo(Node* gp, Node* p, Node* l, Update pupdate){
     return info;
 }
 
-template<typename T, int Threads>
-void NBBST<T, Threads>::releaseNode(Node* node){
-    if(node){
-        if(node->update){
-            infos.releaseNode(Unmark(node->update));
-        }
+template<typename T, int Threads, typename Reclamation>
+bool NBBST<T, Threads, Reclamation>::readInfo(Update update, Info& info){
+    Descriptor& descriptor = descriptors[getThread(update)];
+
+    info = descriptor.info;
 
-        nodes.releaseNode(node);
+    //The fields must be read before the sequence number, which tells if they belong to the operation
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    return descriptor.sequence.load(std::memory_order_relaxed) == getSequence(update);
+}
+
+template<typename T, int Threads, typename Reclamation>
+void NBBST<T, Threads, Reclamation>::publish(Node* child, unsigned int i){
+    if(IsLeaf(child)){
+        leaves.publish(AsLeaf(child), i);
+    } else {
+        nodes.publish(child, i);
     }
 }
 
-template<typename T, int Threads>
-void NBBST<T, Threads>::Search(int key, SearchResult* result){
+template<typename T, int Threads, typename Reclamation>
+void NBBST<T, Threads, Reclamation>::releaseAll(){
+    nodes.releaseAll();
+    leaves.releaseAll();
+}
+
+template<typename T, int Threads, typename Reclamation>
+void NBBST<T, Threads, Reclamation>::releaseChild(Node* child){
+    if(IsLeaf(child)){
+        leaves.releaseNode(AsLeaf(child));
+    } else if(child){
+        nodes.releaseNode(child);
+    }
+}
+
+template<typename T, int Threads, typename Reclamation>
+void NBBST<T, Threads, Reclamation>::Search(int key, SearchResult* result){
     Node* l = root;
 
-    while(l->internal){
+    while(!IsLeaf(l)){
         result->gp = result->p;
         result->p = l;
         result->gpupdate = result->pupdate;
@@ -186,11 +308,14 @@ void NBBST<T, Threads>::Search(int key, SearchResult* result){
         }
     }
 
-    result->l = l;
+    result->l = AsLeaf(l);
 }
 
-template<typename T, int Threads>
-bool NBBST<T, Threads>::contains(T value){
+template<typename T, int Threads, typename Reclamation>
+bool NBBST<T, Threads, Reclamation>::contains(T value){
+    CriticalSection<decltype(nodes)> nodes_critical(nodes);
+    CriticalSection<decltype(leaves)> leaves_critical(leaves);
+
     int key = hash(value);
 
     SearchResult result;
@@ -199,27 +324,25 @@ bool NBBST<T, Threads>::contains(T value){
     return result.l->key == key;
 }
 
-template<typename T, int Threads>
-bool NBBST<T, Threads>::add(T value){
+template<typename T, int Threads, typename Reclamation>
+bool NBBST<T, Threads, Reclamation>::add(T value){
+    CriticalSection<decltype(nodes)> nodes_critical(nodes);
+    CriticalSection<decltype(leaves)> leaves_critical(leaves);
+
     int key = hash(value);
 
-    Node* newNode = newLeaf(key);
+    Leaf* newNode = newLeaf(key);
 
     SearchResult search;
 
     while(true){
         Search(key, &search);
 
-        nodes.publish(search.l, 0);
-            
-        infos.publish(search.p->update, 0);
-        infos.publish(search.pupdate, 1);
+        leaves.publish(search.l, 0);
 
         if(search.l->key == key){
-            nodes.releaseNode(newNode);
-            nodes.releaseAll();
-            
-            infos.releaseAll();
+            leaves.releaseNode(newNode);
+            releaseAll();
 
             return false; //Key already in the set
         }
@@ -227,41 +350,32 @@ bool NBBST<T, Threads>::add(T value){
         if(getState(search.pupdate) != CLEAN){
             Help(search.pupdate);
         } else {
-            Node* newSibling = newLeaf(search.l->key);
+            Leaf* newSibling = newLeaf(search.l->key);
             Node* newInt = newInternal(std::max(key, search.l->key));
-            newInt->update = Mark(nullptr, CLEAN);
+            newInt->update = Mark(0, CLEAN);
             
             //Put the smaller child on the left
             if(newNode->key <= newSibling->key){
-                newInt->left = newNode;
-                newInt->right = newSibling;
+                newInt->left = TagLeaf(newNode);
+                newInt->right = TagLeaf(newSibling);
             } else {
-                newInt->left = newSibling;
-                newInt->right = newNode;
+                newInt->left = TagLeaf(newSibling);
+                newInt->right = TagLeaf(newNode);
             }
 
             Info* op = newIInfo(search.p, newInt, search.l);
-            infos.publish(op, 2);
 
             Update result = search.p->update;
-            if(CASPTR(&search.p->update, search.pupdate, Mark(op, IFLAG))){
+            if(CAS(&search.p->update, search.pupdate, Mark(op->update, IFLAG))){
                 HelpInsert(op);
 
-                if(search.pupdate){
-                    infos.releaseNode(Unmark(search.pupdate));
-                }
-                
-                nodes.releaseAll();
-                infos.releaseAll();
+                releaseAll();
 
                 return true;
             } else {
                 nodes.releaseNode(newInt);
-                nodes.releaseNode(newSibling);
-                nodes.releaseAll();
-                
-                infos.releaseNode(op);
-                infos.releaseAll();
+                leaves.releaseNode(newSibling);
+                releaseAll();
 
                 Help(result);
             }
@@ -269,15 +383,18 @@ bool NBBST<T, Threads>::add(T value){
     }
 }
 
-template<typename T, int Threads>
-bool NBBST<T, Threads>::remove(T value){
+template<typename T, int Threads, typename Reclamation>
+bool NBBST<T, Threads, Reclamation>::remove(T value){
+    CriticalSection<decltype(nodes)> nodes_critical(nodes);
+    CriticalSection<decltype(leaves)> leaves_critical(leaves);
+
     int key = hash(value);
 
     SearchResult search;
 
     while(true){
         Search(key, &search);
-        nodes.publish(search.l, 0);
+        leaves.publish(search.l, 0);
         
         if(search.l->key != key){
             return false;
@@ -288,101 +405,81 @@ bool NBBST<T, Threads>::remove(T value){
         } else if(getState(search.pupdate) != CLEAN){
             Help(search.pupdate);
         } else {
-            infos.publish(search.gp->update, 0);
-            infos.publish(search.gpupdate, 1);
-
             Info* op = newDInfo(search.gp, search.p, search.l, search.pupdate);
-            infos.publish(op, 2);
 
             Update result = search.gp->update;
-            if(CASPTR(&search.gp->update, search.gpupdate, Mark(op, DFLAG))){
-                if(search.gpupdate){
-                    infos.releaseNode(Unmark(search.gpupdate));
-                }
-                
-                infos.releaseAll();
-
+            if(CAS(&search.gp->update, search.gpupdate, Mark(op->update, DFLAG))){
                 if(HelpDelete(op)){
-                    nodes.releaseAll();
+                    releaseAll();
                     
                     return true;
                 }
             } else {
-                infos.releaseNode(op);
-                infos.releaseAll();
-
                 Help(result);
             }
         }
         
-        nodes.releaseAll();
+        releaseAll();
     }
 }
 
-template<typename T, int Threads>
-void NBBST<T, Threads>::Help(Update u){
+template<typename T, int Threads, typename Reclamation>
+void NBBST<T, Threads, Reclamation>::Help(Update u){
+    if(getState(u) == CLEAN){
+        return;
+    }
+
+    //The operation of another thread is helped from a copy of its descriptor
+    Info op;
+    if(!readInfo(u, op)){
+        return;
+    }
+
     if(getState(u) == IFLAG){
-        HelpInsert(Unmark(u));
+        HelpInsert(&op);
     } else if(getState(u) == MARK){
-        HelpMarked(Unmark(u));
+        HelpMarked(&op);
     } else if(getState(u) == DFLAG){
-        HelpDelete(Unmark(u));
+        HelpDelete(&op);
     }
 }
 
-template<typename T, int Threads>
-void NBBST<T, Threads>::HelpInsert(Info* op){
-    infos.publish(op, 0);
-    infos.publish(op->p->update, 1);
-
-    CASChild(op->p, op->l, op->newInternal);
-    CASPTR(&op->p->update, Mark(op, IFLAG), Mark(op, CLEAN));
-
-    infos.releaseAll();
+template<typename T, int Threads, typename Reclamation>
+void NBBST<T, Threads, Reclamation>::HelpInsert(Info* op){
+    CASChild(op->p, TagLeaf(op->l), op->newInternal);
+    CAS(&op->p->update, Mark(op->update, IFLAG), Mark(op->update, CLEAN));
 }
 
-template<typename T, int Threads>
-bool NBBST<T, Threads>::HelpDelete(Info* op){
-    infos.publish(op->p->update, 0);
-    infos.publish(op->pupdate, 1);
-    infos.publish(op, 2);
-
+template<typename T, int Threads, typename Reclamation>
+bool NBBST<T, Threads, Reclamation>::HelpDelete(Info* op){
     Update result = op->p->update;
 
     //If we succeed
-    if(CASPTR(&op->p->update, op->pupdate, Mark(op, MARK))){
-        if(op->pupdate){
-            infos.releaseNode(Unmark(op->pupdate));
-        }
-
-        nodes.releaseNode(op->l);
-        HelpMarked(Unmark(op));
-        infos.releaseAll();
+    if(CAS(&op->p->update, op->pupdate, Mark(op->update, MARK))){
+        leaves.releaseNode(op->l);
+        HelpMarked(op);
         
         return true;
     } 
     //if another has succeeded for us
-    else if(getState(op->p->update) == MARK && Unmark(op->p->update) == Unmark(op)){
-        HelpMarked(Unmark(op));
-        infos.releaseAll();
+    else if(getState(op->p->update) == MARK && Unmark(op->p->update) == op->update){
+        HelpMarked(op);
+
         return true;
     } else {
         Help(result);
 
-        infos.publish(op->gp->update, 0);
-        infos.publish(op, 1);
-        CASPTR(&op->gp->update, Mark(op, DFLAG), Mark(op, CLEAN));
-        infos.releaseAll();
+        CAS(&op->gp->update, Mark(op->update, DFLAG), Mark(op->update, CLEAN));
 
         return false;
     }
 }
 
-template<typename T, int Threads>
-void NBBST<T, Threads>::HelpMarked(Info* op){
+template<typename T, int Threads, typename Reclamation>
+void NBBST<T, Threads, Reclamation>::HelpMarked(Info* op){
     Node* other;
 
-    if(op->p->right == op->l){
+    if(op->p->right == TagLeaf(op->l)){
         other = op->p->left;
     } else {
         other = op->p->right;
@@ -390,34 +487,27 @@ void NBBST<T, Threads>::HelpMarked(Info* op){
 
     CASChild(op->gp, op->p, other);
 
-    infos.publish(op->gp->update, 0);
-    infos.publish(op, 1);
-    CASPTR(&op->gp->update, Mark(op, DFLAG), Mark(op, CLEAN));
-    infos.releaseAll();
+    CAS(&op->gp->update, Mark(op->update, DFLAG), Mark(op->update, CLEAN));
 }
         
-template<typename T, int Threads>
-void NBBST<T, Threads>::CASChild(Node* parent, Node* old, Node* newNode){
-    nodes.publish(old, 0);
-    nodes.publish(newNode, 1);
+template<typename T, int Threads, typename Reclamation>
+void NBBST<T, Threads, Reclamation>::CASChild(Node* parent, Node* old, Node* newNode){
+    publish(old, 0);
+    publish(newNode, 1);
 
-    if(newNode->key < parent->key){
-        nodes.publish(parent->left, 2);
+    if(getKey(newNode) < parent->key){
+        publish(parent->left, 2);
         if(CASPTR(&parent->left, old, newNode)){
-            if(old){
-                nodes.releaseNode(old);
-            }
+            releaseChild(old);
         }
     } else {
-        nodes.publish(parent->right, 2);
+        publish(parent->right, 2);
         if(CASPTR(&parent->right, old, newNode)){
-            if(old){
-                nodes.releaseNode(old);
-            }
+            releaseChild(old);
         }
     }
 
-    nodes.releaseAll();
+    releaseAll();
 }
 
 } //end of nbbst
@@ -0,0 +1,357 @@
+#ifndef NMBST_TREE
+#define NMBST_TREE
+
+#include <limits>
+
+#include "hash.hpp"
+#include "Utils.hpp"
+#include "EpochManager.hpp"
+#include "ThreadRegistry.hpp"
+
+namespace nmbst {
+
+/*!
+ * A node of the tree, the elements are in the leaves, whose children are null.
+ * The keys are wider than the elements to hold the three sentinel keys above all the elements.
+ */
+struct Node {
+    long key;
+    Node* left;
+    Node* right;
+};
+
+/*!
+ * The state of an edge is stored in the lowest bits of the child pointer. A flagged edge leads
+ * to a leaf being removed, a tagged edge is the sibling of a flagged edge. Both never change again.
+ */
+static const unsigned long Flag = 0x1;
+static const unsigned long Tag  = 0x2;
+
+inline Node* Address(Node* edge){
+    return reinterpret_cast<Node*>(reinterpret_cast<unsigned long>(edge) & ~(Flag | Tag));
+}
+
+inline bool IsFlagged(Node* edge){
+    return reinterpret_cast<unsigned long>(edge) & Flag;
+}
+
+inline bool IsTagged(Node* edge){
+    return reinterpret_cast<unsigned long>(edge) & Tag;
+}
+
+inline Node* Flagged(Node* node){
+    return reinterpret_cast<Node*>(reinterpret_cast<unsigned long>(node) | Flag);
+}
+
+inline void TagEdge(Node** edge){
+    __sync_fetch_and_or(reinterpret_cast<unsigned long*>(edge), Tag);
+}
+
+/*!
+ * The nodes found by a seek: the leaf of the key, its parent, and the last edge of the path
+ * that was not tagged, from the ancestor to the successor. Once a leaf is flagged, the whole
+ * path from the successor to its parent is removed by a single swap of this edge.
+ */
+struct SeekRecord {
+    Node* ancestor;
+    Node* successor;
+    Node* parent;
+    Node* leaf;
+};
+
+/*!
+ * A lock-free external binary search tree with edge marking (Natarajan and Mittal).
+ * There is no descriptor: a removal flags the edge to its leaf and then swaps a single edge
+ * above it, all the threads that find a flagged or tagged edge can finish the removal.
+ * The insertions and the removals share the same seek to find their nodes.
+ * The searches go through the removed nodes without validation, which cannot be done with hazard
+ * pointers, so the nodes are protected by epochs by default.
+ */
+template<typename T, int Threads, typename Reclamation = Epochs>
+class NMBST {
+    public:
+        NMBST();
+        ~NMBST();
+
+        bool contains(T value);
+        bool add(T value);
+        bool remove(T value);
+
+        /*!
+         * Return the reclamation counters of all the managers of the structure.
+         */
+        ReclamationStats reclamation_stats();
+
+    private:
+        Node* newNode(long key, Node* left, Node* right);
+
+        void seek(long key, SeekRecord& record);
+
+        /*!
+         * Remove the flagged leaf below the parent of the record, with its sibling if it is flagged too,
+         * by swapping the edge from the ancestor to the successor to the unflagged sibling.
+         * \return true if the edge has been swapped by this thread.
+         */
+        bool cleanup(long key, SeekRecord& record);
+
+        /* Release the nodes removed from the tree by a cleanup */
+        void releasePath(Node* successor, Node* parent, Node* sibling);
+
+        Node* R;
+        Node* S;
+
+        typename Reclaimer<Reclamation, Node, Threads>::type nodes;
+};
+
+//The sentinel keys, above all the keys of the elements
+static const long Infinity0 = static_cast<long>(std::numeric_limits<int>::max()) + 1;
+static const long Infinity1 = Infinity0 + 1;
+static const long Infinity2 = Infinity0 + 2;
+
+template<typename T, int Threads, typename Reclamation>
+Node* NMBST<T, Threads, Reclamation>::newNode(long key, Node* left, Node* right){
+    Node* node = nodes.getFreeNode();
+
+    node->key = key;
+    node->left = left;
+    node->right = right;
+
+    return node;
+}
+
+template<typename T, int Threads, typename Reclamation>
+NMBST<T, Threads, Reclamation>::NMBST(){
+    //The sentinel nodes are never removed, so the seek always has an ancestor, a successor and a parent
+    S = newNode(Infinity1, newNode(Infinity0, nullptr, nullptr), newNode(Infinity1, nullptr, nullptr));
+    R = newNode(Infinity2, S, newNode(Infinity2, nullptr, nullptr));
+}
+
+template<typename T, int Threads, typename Reclamation>
+NMBST<T, Threads, Reclamation>::~NMBST(){
+    //All the nodes are destroyed with the arenas of the manager
+}
+
+template<typename T, int Threads, typename Reclamation>
+ReclamationStats NMBST<T, Threads, Reclamation>::reclamation_stats(){
+    ReclamationStats stats = nodes.stats();
+
+    return stats;
+}
+
+template<typename T, int Threads, typename Reclamation>
+void NMBST<T, Threads, Reclamation>::seek(long key, SeekRecord& record){
+    record.ancestor = R;
+    record.successor = S;
+    record.parent = S;
+    record.leaf = Address(S->left);
+
+    Node* parentField = S->left;
+    Node* currentField = record.leaf->left;
+    Node* current = Address(currentField);
+
+    while(current){
+        //The ancestor and the successor only move on the edges that are not tagged
+        if(!IsTagged(parentField)){
+            record.ancestor = record.parent;
+            record.successor = record.leaf;
+        }
+
+        record.parent = record.leaf;
+        record.leaf = current;
+
+        parentField = currentField;
+        currentField = key < current->key ? current->left : current->right;
+        current = Address(currentField);
+    }
+}
+
+template<typename T, int Threads, typename Reclamation>
+bool NMBST<T, Threads, Reclamation>::contains(T value){
+    CriticalSection<decltype(nodes)> critical(nodes);
+
+    long key = hash(value);
+
+    Node* node = Address(S->left);
+    while(node->left){
+        node = Address(key < node->key ? node->left : node->right);
+    }
+
+    return node->key == key;
+}
+
+template<typename T, int Threads, typename Reclamation>
+bool NMBST<T, Threads, Reclamation>::add(T value){
+    CriticalSection<decltype(nodes)> critical(nodes);
+
+    long key = hash(value);
+
+    //The new nodes are only taken once the key is known to be absent and are kept between the attempts,
+    //so that the failed insertions do not retire nodes
+    Node* newLeaf = nullptr;
+    Node* newInternal = nullptr;
+
+    SeekRecord record;
+
+    while(true){
+        seek(key, record);
+
+        Node* leaf = record.leaf;
+        Node* parent = record.parent;
+
+        if(leaf->key == key){
+            if(newLeaf){
+                nodes.releaseNode(newLeaf);
+                nodes.releaseNode(newInternal);
+            }
+
+            return false;
+        }
+
+        if(!newLeaf){
+            newLeaf = newNode(key, nullptr, nullptr);
+            newInternal = nodes.getFreeNode();
+        }
+
+        if(key < leaf->key){
+            newInternal->key = leaf->key;
+            newInternal->left = newLeaf;
+            newInternal->right = leaf;
+        } else {
+            newInternal->key = key;
+            newInternal->left = leaf;
+            newInternal->right = newLeaf;
+        }
+
+        Node** childAddr = key < parent->key ? &parent->left : &parent->right;
+
+        if(CASPTR(childAddr, leaf, newInternal)){
+            return true;
+        }
+
+        //The leaf is being removed, the removal is finished before retrying
+        Node* child = *childAddr;
+        if(Address(child) == leaf && (IsFlagged(child) || IsTagged(child))){
+            cleanup(key, record);
+        }
+    }
+}
+
+template<typename T, int Threads, typename Reclamation>
+bool NMBST<T, Threads, Reclamation>::remove(T value){
+    CriticalSection<decltype(nodes)> critical(nodes);
+
+    long key = hash(value);
+
+    SeekRecord record;
+    Node* leaf = nullptr;
+
+    //Inject the removal by flagging the edge to the leaf
+    while(true){
+        seek(key, record);
+
+        Node* parent = record.parent;
+
+        if(record.leaf->key != key){
+            return false;
+        }
+
+        leaf = record.leaf;
+
+        Node** childAddr = key < parent->key ? &parent->left : &parent->right;
+
+        if(CASPTR(childAddr, leaf, Flagged(leaf))){
+            break;
+        }
+
+        //Help the removal of the leaf or of its sibling that prevents the flagging
+        Node* child = *childAddr;
+        if(Address(child) == leaf && (IsFlagged(child) || IsTagged(child))){
+            cleanup(key, record);
+        }
+    }
+
+    //The leaf is removed from now on, it only remains to detach it
+    if(cleanup(key, record)){
+        return true;
+    }
+
+    while(true){
+        seek(key, record);
+
+        //Another thread has detached the leaf
+        if(record.leaf != leaf){
+            return true;
+        }
+
+        if(cleanup(key, record)){
+            return true;
+        }
+    }
+}
+
+template<typename T, int Threads, typename Reclamation>
+bool NMBST<T, Threads, Reclamation>::cleanup(long key, SeekRecord& record){
+    Node* ancestor = record.ancestor;
+    Node* successor = record.successor;
+    Node* parent = record.parent;
+
+    Node** successorAddr = key < ancestor->key ? &ancestor->left : &ancestor->right;
+
+    Node** childAddr;
+    Node** siblingAddr;
+
+    if(key < parent->key){
+        childAddr = &parent->left;
+        siblingAddr = &parent->right;
+    } else {
+        childAddr = &parent->right;
+        siblingAddr = &parent->left;
+    }
+
+    //The leaf of the key is not the flagged one, this is a removal of its sibling
+    if(!IsFlagged(*childAddr)){
+        siblingAddr = childAddr;
+    }
+
+    //The sibling cannot change anymore, it is moved up with its flag, to be removed later if it is flagged
+    TagEdge(siblingAddr);
+    Node* sibling = *siblingAddr;
+
+    Node* replacement = IsFlagged(sibling) ? Flagged(Address(sibling)) : Address(sibling);
+
+    if(CASPTR(successorAddr, successor, replacement)){
+        releasePath(successor, parent, Address(sibling));
+
+        return true;
+    }
+
+    return false;
+}
+
+template<typename T, int Threads, typename Reclamation>
+void NMBST<T, Threads, Reclamation>::releasePath(Node* successor, Node* parent, Node* sibling){
+    //Each node of the path has a flagged leaf on one side, all the edges are frozen
+    Node* node = successor;
+
+    while(node != parent){
+        Node* next;
+
+        if(IsFlagged(node->left)){
+            nodes.releaseNode(Address(node->left));
+            next = Address(node->right);
+        } else {
+            nodes.releaseNode(Address(node->right));
+            next = Address(node->left);
+        }
+
+        nodes.releaseNode(node);
+        node = next;
+    }
+
+    nodes.releaseNode(Address(parent->left) == sibling ? Address(parent->right) : Address(parent->left));
+    nodes.releaseNode(parent);
+}
+
+} //end of nmbst
+
+#endif
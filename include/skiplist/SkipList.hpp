@@ -1,27 +1,29 @@
 #ifndef SKIP_LIST
 #define SKIP_LIST
 
+#include <atomic>
+#include <type_traits>
+
 #include "hash.hpp"
 #include "Utils.hpp"
 #include "HazardManager.hpp"
+#include "ThreadRegistry.hpp"
 
-#define MAX_LEVEL 24 //Should be choosen as log(1/p)(n)
-#define P 0.5        //probability for randomLevel (geometric distribution)
+#define MAX_LEVEL 32 //The searches start at the level adapted to the size, so the higher levels cost nothing
+#define FINGER_LEVEL 4 //The level of the predecessor kept as finger, its span is around 2^FINGER_LEVEL elements
 
 namespace skiplist {
 
+/*!
+ * The fixed part of a node. The levels of the node are stored right after it, 
+ * in a tower carved with room for its height. 
+ */
 struct Node {
     int key;
     int topLevel;
-    Node** next;
-    
-    Node(){
-        //Fill the array with null pointers
-        next = static_cast<Node**>(calloc(MAX_LEVEL + 1, sizeof(Node *)));
-    }
 
-    ~Node(){
-        free(next);    
+    Node** next(){
+        return reinterpret_cast<Node**>(this + 1);
     }
 };
 
@@ -37,7 +39,20 @@ inline bool IsMarked(Node* node){
     return reinterpret_cast<unsigned long>(node) & 0x1;
 }
 
-template<typename T, int Threads>
+/*!
+ * The towers of the nodes, by number of levels. 
+ */
+struct Towers {
+    typedef Node node_type;
+
+    template<unsigned int Height>
+    struct tower {
+        Node node;              //Must be the first member
+        Node* next[Height];
+    };
+};
+
+template<typename T, int Threads, typename Reclamation = HazardPointers>
 class SkipList {
     public:
         SkipList();
@@ -47,59 +62,161 @@ class SkipList {
         bool remove(T value);
         bool contains(T value);
 
+        /*!
+         * Apply the functor to the key of each element in [lo, hi], in increasing order. 
+         * The elements are read one by one on the lowest level, so the scan is not atomic: an element 
+         * added or removed during the scan may or may not be seen, but no element is seen twice. 
+         * \param lo The lowest value of the range. 
+         * \param hi The highest value of the range. 
+         * \param functor The functor to apply, taking the key (int) of an element. 
+         */
+        template<typename Functor>
+        void for_each_in_range(T lo, T hi, Functor functor);
+
+        /*!
+         * Return the number of elements in [lo, hi], with the same guarantees as for_each_in_range. 
+         */
+        unsigned int count_range(T lo, T hi);
+
+        /*!
+         * Remove the smallest element, to use the list as a priority queue. The first element that 
+         * is not removed is claimed with a single CAS on its lowest level, the removed nodes before 
+         * it are unlinked together by the next search that meets them. 
+         * \param key Set to the key of the removed element. 
+         * \return false if the list is empty. 
+         */
+        bool pop_min(int& key);
+
+        /*!
+         * Read the smallest element without removing it. 
+         * \param key Set to the key of the smallest element. 
+         * \return false if the list is empty. 
+         */
+        bool peek_min(int& key);
+
+        /*!
+         * Return the reclamation counters of all the managers of the structure. 
+         */
+        ReclamationStats reclamation_stats();
+
     private:
         int randomLevel();
-        bool find(int key, Node** preds, Node** succs);
+
+        /*!
+         * Search the predecessors and the successors of the key, starting from the finger of the 
+         * calling thread when the key is in its span, otherwise from the head. 
+         * \param height The highest level for which the predecessors and successors are needed. 
+         * \return true if the key is in the list. 
+         */
+        bool find(int key, Node** preds, Node** succs, int height);
+
+        /*!
+         * Return the first node of the lowest level that is not removed, protected by the 
+         * second reference, or the tail if the list is empty. 
+         */
+        Node* firstElement();
+
+        /*!
+         * Release the references of the operation, the finger stays protected. 
+         */
+        void releaseReferences();
+
+        /*!
+         * Count an element added (1) or removed (-1) by the calling thread and adapt the level 
+         * of the searches to the size of the list from time to time. 
+         */
+        void updateSize(long delta);
+
+        /*!
+         * Return the level from which the head searches start. 
+         */
+        int startLevel();
 
         Node* newNode(int key, int height);
 
         Node* head;
         Node* tail;
 
-        HazardManager<Node, Threads, 3> hazard;
+        //Only a hazard pointer can protect the finger between two operations, the other policies 
+        //protect the nodes only during the critical sections
+        static const bool Fingers = std::is_same<Reclamation, HazardPointers>::value;
+        static const unsigned int Finger = 3;  //The reference protecting the finger
+        static const unsigned int Inserted = 4;  //The reference protecting a node until all its levels are linked
+
+        //The last predecessor on FINGER_LEVEL found by each thread
+        ThreadTable<Node*> fingers;
+
+        /*!
+         * The elements added minus the elements removed by the threads of a slot. 
+         */
+        struct SizeCounter {
+            std::atomic<long> size;
+            unsigned int updates;       //Only read by the owner, to sum the sizes every UpdatesPerLevel updates
+        };
+
+        static const unsigned int UpdatesPerLevel = 64;
 
-        std::mt19937_64 engine;
-        std::geometric_distribution<int> distribution;
+        ThreadTable<SizeCounter> sizes;
+
+        //log2 of the approximate size, the higher levels hold about one node, it is only a hint: 
+        //the nodes above it are still found, and the searches that need more levels start higher
+        std::atomic<int> searchLevel;
+
+        //Three quarters of the nodes have at most two levels, so the classes are finer for the small towers
+        SizeClasses<Reclamation, Towers, Threads, 5, 2, 4, 8, MAX_LEVEL + 1> hazard;
 };
 
-template<typename T, int Threads>
-Node* SkipList<T, Threads>::newNode(int key, int height){
-    Node* node = hazard.getFreeNode();
+template<typename T, int Threads, typename Reclamation>
+Node* SkipList<T, Threads, Reclamation>::newNode(int key, int height){
+    Node* node = hazard.getFreeNode(height + 1);
 
     node->key = key;
     node->topLevel = height;
 
-    //Make sure everything gets set to null
-    std::fill(node->next, node->next + MAX_LEVEL + 1, nullptr);
+    //Make sure all the levels get set to null
+    std::fill(node->next(), node->next() + height + 1, nullptr);
 
     return node;
 }
 
-template<typename T, int Threads>
-SkipList<T, Threads>::SkipList() : engine(time(NULL)), distribution(P) {
+template<typename T, int Threads, typename Reclamation>
+SkipList<T, Threads, Reclamation>::SkipList() : fingers(Threads), sizes(Threads), searchLevel(0) {
     head = newNode(std::numeric_limits<int>::min(), MAX_LEVEL);
-    tail = newNode(std::numeric_limits<int>::max(), 0);
+
+    //The traversals read the levels of the tail at every level, they are all null
+    tail = newNode(std::numeric_limits<int>::max(), MAX_LEVEL);
 
     for(int i = 0; i < MAX_LEVEL + 1; ++i){
-        head->next[i] = tail;
+        head->next()[i] = tail;
     }
 }
 
-template<typename T, int Threads>
-SkipList<T, Threads>::~SkipList(){
+template<typename T, int Threads, typename Reclamation>
+SkipList<T, Threads, Reclamation>::~SkipList(){
     hazard.releaseNode(tail);
     hazard.releaseNode(head);
 }
 
-template<typename T, int Threads>
-int SkipList<T, Threads>::randomLevel(){
-    int level = distribution(engine); 
-    
-    return (level >= MAX_LEVEL) ? MAX_LEVEL : level;
+template<typename T, int Threads, typename Reclamation>
+ReclamationStats SkipList<T, Threads, Reclamation>::reclamation_stats(){
+    ReclamationStats stats = hazard.stats();
+
+    return stats;
 }
 
-template<typename T, int Threads>
-bool SkipList<T, Threads>::add(T value){
+template<typename T, int Threads, typename Reclamation>
+int SkipList<T, Threads, Reclamation>::randomLevel(){
+    //Each bit is a draw of probability 1/2, the level is the number of successes before the first failure (geometric distribution)
+    //thread_random() draws 32 bits, enough for all the levels, and the bit MAX_LEVEL caps the level
+    static_assert(MAX_LEVEL <= 32, "thread_random() only draws 32 levels");
+
+    return __builtin_ctzl(thread_random() | (1ul << MAX_LEVEL));
+}
+
+template<typename T, int Threads, typename Reclamation>
+bool SkipList<T, Threads, Reclamation>::add(T value){
+    CriticalSection<decltype(hazard)> critical(hazard);
+
     int key = hash(value);
     int topLevel = randomLevel();
 
@@ -107,38 +224,61 @@ bool SkipList<T, Threads>::add(T value){
     Node* succs[MAX_LEVEL + 1];
             
     Node* newElement = newNode(key, topLevel);
-    hazard.publish(newElement, 0);
+
+    //A removal can start as soon as the lowest level is linked, the node must not be freed before its other levels are
+    hazard.publish(newElement, Inserted);
 
     while(true){
-        if(find(key, preds, succs)){
-            hazard.releaseAll();
+        if(find(key, preds, succs, topLevel)){
+            releaseReferences();
+            hazard.release(Inserted);
             
             hazard.releaseNode(newElement);
 
             return false;
         } else {
             for(int level = 0; level <= topLevel; ++level){
-                newElement->next[level] = succs[level];
+                newElement->next()[level] = succs[level];
             }
 
-            hazard.publish(preds[0]->next[0], 1);
+            hazard.publish(preds[0]->next()[0], 1);
             hazard.publish(succs[0], 2);
             
-            if(CASPTR(&preds[0]->next[0], succs[0], newElement)){
+            if(CASPTR(&preds[0]->next()[0], succs[0], newElement)){
                 for(int level = 1; level <= topLevel; ++level){
                     while(true){
-                        hazard.publish(preds[level]->next[level], 1);
+                        Node* succ = newElement->next()[level];
+
+                        //The node is being removed, the levels are marked from the top so none of the next ones is linked
+                        if(IsMarked(succ)){
+                            break;
+                        }
+
+                        //After a new search, the level must point to the new successor, the old one may have been removed
+                        if(succ != succs[level] && !CASPTR(&newElement->next()[level], succ, succs[level])){
+                            continue;
+                        }
+
+                        hazard.publish(preds[level]->next()[level], 1);
                         hazard.publish(succs[level], 2);
 
-                        if(CASPTR(&preds[level]->next[level], succs[level], newElement)){ 
+                        if(CASPTR(&preds[level]->next()[level], succs[level], newElement)){ 
                             break;
                         } else {
-                            find(key, preds, succs);
+                            find(key, preds, succs, topLevel);
                         }
                     }
                 }
+
+                //A level linked after the removal has unlinked the node must be unlinked again
+                if(IsMarked(newElement->next()[0])){
+                    find(key, preds, succs, topLevel);
+                }
             
-                hazard.releaseAll();
+                releaseReferences();
+                hazard.release(Inserted);
+
+                updateSize(1);
 
                 return true;
             }
@@ -146,15 +286,17 @@ bool SkipList<T, Threads>::add(T value){
     }
 }
 
-template<typename T, int Threads>
-bool SkipList<T, Threads>::remove(T value){
+template<typename T, int Threads, typename Reclamation>
+bool SkipList<T, Threads, Reclamation>::remove(T value){
+    CriticalSection<decltype(hazard)> critical(hazard);
+
     int key = hash(value);
 
     Node* preds[MAX_LEVEL + 1];
     Node* succs[MAX_LEVEL + 1];
 
     while(true){
-        if(!find(key, preds, succs)){
+        if(!find(key, preds, succs, 0)){
             hazard.release(1);
             hazard.release(0);
 
@@ -166,29 +308,33 @@ bool SkipList<T, Threads>::remove(T value){
             for(int level = nodeToRemove->topLevel; level > 0; --level){
                 Node* succ = nullptr;
                 do {
-                    succ = nodeToRemove->next[level];
+                    succ = nodeToRemove->next()[level];
                     hazard.publish(succ, 1);
 
                     if(IsMarked(succ)){
                         break;
                     }
-                } while (!CASPTR(&nodeToRemove->next[level], succ, Mark(succ)));
+                } while (!CASPTR(&nodeToRemove->next()[level], succ, Mark(succ)));
             }
 
             while(true){
-                Node* succ = nodeToRemove->next[0];
+                Node* succ = nodeToRemove->next()[0];
                 hazard.publish(succ, 1);
 
                 if(IsMarked(succ)){
                     break;
-                } else if(CASPTR(&nodeToRemove->next[0], succ, Mark(succ))){
+                } else if(CASPTR(&nodeToRemove->next()[0], succ, Mark(succ))){
                     hazard.release(1);
                     hazard.release(0);
                     
-                    find(key, preds, succs);
+                    //All the levels of the node must be unlinked before it is released
+                    find(key, preds, succs, nodeToRemove->topLevel);
+                    releaseReferences();
                     
                     hazard.releaseNode(nodeToRemove);
 
+                    updateSize(-1);
+
                     return true;
                 }
             }
@@ -196,23 +342,34 @@ bool SkipList<T, Threads>::remove(T value){
     }
 }
 
-template<typename T, int Threads>
-bool SkipList<T, Threads>::contains(T value){
+template<typename T, int Threads, typename Reclamation>
+bool SkipList<T, Threads, Reclamation>::contains(T value){
+    CriticalSection<decltype(hazard)> critical(hazard);
+
     int key = hash(value);
 
     Node* pred = head;
     Node* curr = nullptr;
     Node* succ = nullptr;
 
-    for(int level = MAX_LEVEL; level >= 0; --level){
-        curr = Unmark(pred->next[level]);
+    //Start from the finger if the key is in its span and the finger is not being removed
+    if(Fingers){
+        Node* finger = fingers[thread_num];
+
+        if(finger && finger->key < key && !IsMarked(finger->next()[FINGER_LEVEL]) && Unmark(finger->next()[FINGER_LEVEL])->key >= key){
+            pred = finger;
+        }
+    }
+
+    for(int level = pred == head ? startLevel() : FINGER_LEVEL; level >= 0; --level){
+        curr = Unmark(pred->next()[level]);
 
         while(true){
-            succ = curr->next[level];
+            succ = curr->next()[level];
 
             while(IsMarked(succ)){
-                curr = Unmark(curr->next[level]);
-                succ = curr->next[level]; 
+                curr = Unmark(curr->next()[level]);
+                succ = curr->next()[level]; 
             }
 
             if(curr->key < key){
@@ -229,48 +386,265 @@ bool SkipList<T, Threads>::contains(T value){
     return found;
 }
 
-template<typename T, int Threads>
-bool SkipList<T, Threads>::find(int key, Node** preds, Node** succs){
+template<typename T, int Threads, typename Reclamation>
+template<typename Functor>
+void SkipList<T, Threads, Reclamation>::for_each_in_range(T lo, T hi, Functor functor){
+    CriticalSection<decltype(hazard)> critical(hazard);
+
+    int from = hash(lo);
+    int to = hash(hi);
+
+    Node* preds[MAX_LEVEL + 1];
+    Node* succs[MAX_LEVEL + 1];
+
+    //pred and curr are protected by find
+    find(from, preds, succs, 0);
+
+    Node* pred = preds[0];
+    Node* curr = succs[0];
+
+    while(curr != tail && curr->key <= to){
+        Node* succ = curr->next()[0];
+        hazard.publish(Unmark(succ), 2);
+
+        //succ is only protected if curr still points to it
+        if(curr->next()[0] != succ){
+            continue;
+        }
+
+        if(IsMarked(succ)){
+            //curr is being removed, unlink it to go on from pred
+            if(CASPTR(&pred->next()[0], curr, Unmark(succ))){
+                curr = Unmark(succ);
+                hazard.publish(curr, 1);
+            } else {
+                //pred has been removed or another node inserted after it, go back after the last key seen
+                find(from, preds, succs, 0);
+
+                pred = preds[0];
+                curr = succs[0];
+            }
+
+            continue;
+        }
+
+        functor(curr->key);
+
+        //The tail is the only node with the maximal key
+        from = curr->key + 1;
+
+        pred = curr;
+        hazard.publish(pred, 0);
+
+        curr = succ;
+        hazard.publish(curr, 1);
+    }
+
+    releaseReferences();
+}
+
+template<typename T, int Threads, typename Reclamation>
+unsigned int SkipList<T, Threads, Reclamation>::count_range(T lo, T hi){
+    unsigned int count = 0;
+
+    for_each_in_range(lo, hi, [&count](int /*key*/){ ++count; });
+
+    return count;
+}
+
+template<typename T, int Threads, typename Reclamation>
+bool SkipList<T, Threads, Reclamation>::pop_min(int& key){
+    CriticalSection<decltype(hazard)> critical(hazard);
+
+    Node* preds[MAX_LEVEL + 1];
+    Node* succs[MAX_LEVEL + 1];
+
+    while(true){
+        Node* nodeToRemove = firstElement();
+
+        if(nodeToRemove == tail){
+            releaseReferences();
+
+            return false;
+        }
+
+        //As in remove, the higher levels are marked first, the poppers competing for the same node 
+        //help each other to mark them and the one marking the lowest level claims the node
+        for(int level = nodeToRemove->topLevel; level > 0; --level){
+            Node* succ = nullptr;
+            do {
+                succ = nodeToRemove->next()[level];
+
+                if(IsMarked(succ)){
+                    break;
+                }
+            } while (!CASPTR(&nodeToRemove->next()[level], succ, Mark(succ)));
+        }
+
+        while(true){
+            Node* succ = nodeToRemove->next()[0];
+
+            if(IsMarked(succ)){
+                break;
+            } else if(CASPTR(&nodeToRemove->next()[0], succ, Mark(succ))){
+                key = nodeToRemove->key;
+
+                //The node is only released by the popper that claimed it, the search unlinks it 
+                //with the other removed nodes before it if they are still linked
+                find(key, preds, succs, nodeToRemove->topLevel);
+                releaseReferences();
+
+                hazard.releaseNode(nodeToRemove);
+
+                updateSize(-1);
+
+                return true;
+            }
+        }
+    }
+}
+
+template<typename T, int Threads, typename Reclamation>
+bool SkipList<T, Threads, Reclamation>::peek_min(int& key){
+    CriticalSection<decltype(hazard)> critical(hazard);
+
+    Node* first = firstElement();
+    key = first->key;
+
+    releaseReferences();
+
+    return first != tail;
+}
+
+template<typename T, int Threads, typename Reclamation>
+Node* SkipList<T, Threads, Reclamation>::firstElement(){
+retry:
+    //The removed nodes after the head can only be unlinked from the head and their levels are frozen, 
+    //so they stay protected as long as the head points to the first of them
+    Node* first = head->next()[0];
+    hazard.publish(first, 0);
+
+    if(head->next()[0] != first){
+        goto retry;
+    }
+
+    Node* curr = first;
+    hazard.publish(curr, 1);
+
+    while(true){
+        Node* succ = curr->next()[0];
+
+        if(!IsMarked(succ)){
+            hazard.release(2);
+
+            return curr;
+        }
+
+        hazard.publish(Unmark(succ), 2);
+
+        if(head->next()[0] != first){
+            goto retry;
+        }
+
+        curr = Unmark(succ);
+        hazard.publish(curr, 1);
+    }
+}
+
+template<typename T, int Threads, typename Reclamation>
+bool SkipList<T, Threads, Reclamation>::find(int key, Node** preds, Node** succs, int height){
     Node* pred = nullptr;
     Node* curr = nullptr;
     Node* succ = nullptr;
+
+    Node* start = head;
+    bool fromFinger = false;
+    int top = 0;
+
+    //The finger is protected, it must be before the key and the levels needed must be under FINGER_LEVEL, 
+    //the level on which it has been found, its higher levels may not be linked yet
+    if(Fingers && height <= FINGER_LEVEL){
+        Node* finger = fingers[thread_num];
+
+        if(finger && finger->key < key){
+            start = finger;
+        }
+    }
         
 retry:
     //We must do to release after the goto
-    hazard.releaseAll();
+    releaseReferences();
     
-    pred = head;
+    pred = start;
     hazard.publish(pred, 0);
 
-    for(int level = MAX_LEVEL; level >= 0; --level){
-        curr = pred->next[level];
+    //If the finger has been removed or the key is not in its span, the search starts again from the head
+    fromFinger = start != head;
+    top = fromFinger ? FINGER_LEVEL : std::max(startLevel(), height);
+    start = head;
+
+    //Each reference is only protected if it is still linked after being published
+    for(int level = top; level >= 0; --level){
+        curr = pred->next()[level];
         hazard.publish(curr, 1);
 
+        if(pred->next()[level] != curr){
+            goto retry;
+        }
+
         while(true){
             if(IsMarked(curr)){
                 goto retry;
             }
 
-            succ = curr->next[level];
-            hazard.publish(succ, 2);
+            succ = curr->next()[level];
+            hazard.publish(Unmark(succ), 2);
+
+            if(curr->next()[level] != succ){
+                goto retry;
+            }
 
             while(IsMarked(succ)){
-                if(!CASPTR(&pred->next[level], curr, Unmark(succ))){
+                //The nodes marked on this level after curr are unlinked with it in one CAS, their levels are 
+                //frozen so they are protected as long as pred still points to curr
+                Node* next = Unmark(succ);
+                Node* after = next->next()[level];
+
+                while(IsMarked(after)){
+                    hazard.publish(Unmark(after), 2);
+
+                    if(pred->next()[level] != curr){
+                        goto retry;
+                    }
+
+                    next = Unmark(after);
+                    after = next->next()[level];
+                }
+
+                if(!CASPTR(&pred->next()[level], curr, next)){
                     goto retry;
                 }
 
-                curr = pred->next[level];
+                curr = pred->next()[level];
                 hazard.publish(curr, 1);
 
-                if(IsMarked(curr)){
+                if(pred->next()[level] != curr || IsMarked(curr)){
                     goto retry;
                 }
 
-                succ = curr->next[level];
-                hazard.publish(succ, 2);
+                succ = curr->next()[level];
+                hazard.publish(Unmark(succ), 2);
+
+                if(curr->next()[level] != succ){
+                    goto retry;
+                }
             }
 
             if(curr->key < key){
+                if(fromFinger && level == top){
+                    goto retry;
+                }
+
                 pred = curr;
                 hazard.publish(pred, 0);
                 
@@ -283,15 +657,62 @@ retry:
 
         preds[level] = pred;
         succs[level] = curr;
+
+        //pred is still protected by the first reference, it is protected as finger before being left
+        if(Fingers && level == FINGER_LEVEL){
+            Node*& finger = fingers[thread_num];
+
+            if(pred != finger){
+                hazard.release(Finger);
+                hazard.publish(pred, Finger);
+
+                finger = pred;
+            }
+        }
     }
 
     bool found = curr->key == key;
     
-    hazard.releaseAll();
+    //The predecessor and the successor on the lowest level stay protected
+    hazard.release(2);
 
     return found;
 }
 
+template<typename T, int Threads, typename Reclamation>
+inline int SkipList<T, Threads, Reclamation>::startLevel(){
+    return searchLevel.load(std::memory_order_relaxed);
+}
+
+template<typename T, int Threads, typename Reclamation>
+void SkipList<T, Threads, Reclamation>::updateSize(long delta){
+    SizeCounter& counter = sizes[thread_num];
+
+    counter.size.store(counter.size.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+
+    if(++counter.updates % UpdatesPerLevel == 0){
+        long size = 0;
+        sizes.for_each([&size](SizeCounter& other){ size += other.size.load(std::memory_order_relaxed); });
+
+        //Half of the nodes have at least two levels, so the level l holds about size / 2^l nodes
+        int adapted = 0;
+        while(adapted < MAX_LEVEL && (size >> (adapted + 1)) > 0){
+            ++adapted;
+        }
+
+        if(adapted != searchLevel.load(std::memory_order_relaxed)){
+            searchLevel.store(adapted, std::memory_order_relaxed);
+        }
+    }
+}
+
+template<typename T, int Threads, typename Reclamation>
+void SkipList<T, Threads, Reclamation>::releaseReferences(){
+    hazard.release(0);
+    hazard.release(1);
+    hazard.release(2);
+}
+
 }
 
 #endif
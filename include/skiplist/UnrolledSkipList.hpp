@@ -0,0 +1,874 @@
+#ifndef UNROLLED_SKIP_LIST
+#define UNROLLED_SKIP_LIST
+
+#include <algorithm>
+#include <atomic>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "hash.hpp"
+#include "Utils.hpp"
+#include "HazardManager.hpp"
+#include "ThreadRegistry.hpp"
+
+#define BLOCK_MAX_LEVEL 28 //There are about BLOCK_KEYS / 2 times less blocks than elements
+#define BLOCK_KEYS 16 //The keys of a block fill a cache line
+
+namespace skiplist {
+
+/*!
+ * A sorted array of keys, never modified once published: the updates replace it by a copy.
+ * The unused slots hold the maximal key, so that the array can always be compared entirely.
+ */
+struct Keys {
+    int values[BLOCK_KEYS];
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+/*!
+ * Return the number of keys of the array less than the given key, which is also the index where the key is or would be.
+ */
+inline unsigned int rank(const Keys* keys, int key){
+#ifdef __SSE2__
+    __m128i pivot = _mm_set1_epi32(key);
+    unsigned int less = 0;
+
+    //The keys are sorted, so the number of keys less than the key is the number of bits set
+    for(unsigned int i = 0; i < BLOCK_KEYS; i += 4){
+        __m128i values = _mm_load_si128(reinterpret_cast<const __m128i*>(keys->values + i));
+        less |= _mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(values, pivot))) << i;
+    }
+
+    return __builtin_popcount(less);
+#else
+    return std::lower_bound(keys->values, keys->values + BLOCK_KEYS, key) - keys->values;
+#endif
+}
+
+/*!
+ * Return the number of keys in the array.
+ */
+inline unsigned int size(const Keys* keys){
+    return rank(keys, std::numeric_limits<int>::max());
+}
+
+/*!
+ * A block of the list. Its keys are all in [key, key of the next block[, the block with the
+ * lowest key is the head, so every key belongs to exactly one block. The key of a block never changes.
+ */
+struct Block {
+    int key;
+    int topLevel;
+    Keys* keys;         //The marked descriptor of its split while frozen, null once the block is removed
+    bool linked;        //Set once the block is linked on all its levels, only then it can be removed
+
+    Block** next(){
+        return reinterpret_cast<Block**>(this + 1);
+    }
+};
+
+inline Block* Unmark(Block* block){
+    return reinterpret_cast<Block*>(reinterpret_cast<unsigned long>(block) & (~0l - 1));
+}
+
+inline Block* Mark(Block* block){
+    return reinterpret_cast<Block*>(reinterpret_cast<unsigned long>(block) | 0x1);
+}
+
+inline bool IsMarked(Block* block){
+    return reinterpret_cast<unsigned long>(block) & 0x1;
+}
+
+/*!
+ * The states of a split, in its descriptor.
+ */
+enum SplitState {
+    PENDING = 0,        //The keys of the block are not frozen yet
+    FROZEN  = 1,        //The keys are frozen, the split is finished by linking the new block
+    ABORTED = 2         //The keys have been updated before being frozen
+};
+
+/*!
+ * The descriptor of the split of a block, with everything needed by any thread to finish it.
+ * It is announced in the lowest link of the block, then it replaces the keys of the block to freeze them.
+ */
+struct Split {
+    Keys* keys;         //The keys of the block before the split
+    Keys* lower;        //The keys of the block after the split
+    Block* sibling;     //The new block, with the upper keys
+    Block* succ;        //The successor of the block when the split has been announced
+    std::atomic<int> state;
+};
+
+inline Keys* Freeze(Split* split){
+    return reinterpret_cast<Keys*>(reinterpret_cast<unsigned long>(split) | 0x1);
+}
+
+inline bool IsFrozen(Keys* keys){
+    return reinterpret_cast<unsigned long>(keys) & 0x1;
+}
+
+inline Split* AsSplit(Keys* keys){
+    return reinterpret_cast<Split*>(reinterpret_cast<unsigned long>(keys) & (~0l - 1));
+}
+
+/*!
+ * Return the keys of a block from its keys field, the frozen keys of a block being split are still its keys.
+ */
+inline Keys* Unfreeze(Keys* keys){
+    return IsFrozen(keys) ? AsSplit(keys)->keys : keys;
+}
+
+inline Block* Splitting(Split* split){
+    return reinterpret_cast<Block*>(reinterpret_cast<unsigned long>(split) | 0x2);
+}
+
+inline bool IsSplitting(Block* block){
+    return reinterpret_cast<unsigned long>(block) & 0x2;
+}
+
+inline Split* AsSplit(Block* block){
+    return reinterpret_cast<Split*>(reinterpret_cast<unsigned long>(block) & ~0x2l);
+}
+
+/*!
+ * The towers of the blocks, by number of levels.
+ */
+struct BlockTowers {
+    typedef Block node_type;
+
+    template<unsigned int Height>
+    struct tower {
+        Block node;             //Must be the first member
+        Block* next[Height];
+    };
+};
+
+/*!
+ * A lock-free skip list storing up to BLOCK_KEYS elements in each of its blocks. The blocks are
+ * linked like the nodes of SkipList, the keys of a block are replaced with a CAS by an updated copy.
+ * A full block is split in two: the split is announced in the lowest link of the block, its keys
+ * are frozen, a new block with their upper half is linked after it, then their lower half replaces them.
+ * Each step is a CAS from a value unique to the split, so the threads finding a split finish it,
+ * or abort it if the keys have been updated before being frozen. A block is removed once it is empty.
+ */
+template<typename T, int Threads, typename Reclamation = HazardPointers>
+class UnrolledSkipList {
+    public:
+        UnrolledSkipList();
+        ~UnrolledSkipList();
+
+        bool add(T value);
+        bool remove(T value);
+        bool contains(T value);
+
+        /*!
+         * Apply the functor to the key of each element in [lo, hi], in increasing order, with the 
+         * same guarantees as SkipList::for_each_in_range. The keys are read a block at a time. 
+         * \param lo The lowest value of the range. 
+         * \param hi The highest value of the range. 
+         * \param functor The functor to apply, taking the key (int) of an element. 
+         */
+        template<typename Functor>
+        void for_each_in_range(T lo, T hi, Functor functor);
+
+        /*!
+         * Return the number of elements in [lo, hi], with the same guarantees as for_each_in_range. 
+         */
+        unsigned int count_range(T lo, T hi);
+
+        /*!
+         * Return the reclamation counters of all the managers of the structure.
+         */
+        ReclamationStats reclamation_stats();
+
+    private:
+        int randomLevel();
+
+        /*!
+         * Search the predecessors and the successors of the key. The predecessor and the successor on the
+         * lowest level stay protected.
+         * \param height The highest level for which the predecessors and successors are needed.
+         * \return true if a block has this key.
+         */
+        bool find(int key, Block** preds, Block** succs, int height);
+
+        /*!
+         * Return the block the key belongs to and its keys, both protected. 
+         */
+        Block* locate(int key, Keys*& keys, Block** preds, Block** succs);
+
+        /*!
+         * Return the keys field of the block, the keys it stands for and its split are protected.
+         */
+        Keys* protectKeys(Block* block);
+
+        /*!
+         * Split the full block, adding the key to the half it belongs to.
+         * \return false if the keys of the block have changed, nothing is done then.
+         */
+        bool split(Block* block, Keys* keys, int key);
+
+        /*!
+         * Finish the split of the block, which must be protected.
+         * \return true if the block has been split, false if the split has been aborted.
+         */
+        bool helpSplit(Block* block, Split* split);
+
+        /*!
+         * Finish the split of the block if the next block read from its lowest link is the announce of a split.
+         * \return true if it was a split, the link has changed since.
+         */
+        bool finishSplit(Block* block, Block* next);
+
+        /*!
+         * Link a new block on the levels above the lowest one.
+         */
+        void link(Block* block);
+
+        /*!
+         * Mark all the levels of the removed block and unlink it.
+         */
+        void unlink(Block* block);
+
+        Block* newBlock(int key, int height, Keys* keys);
+        Keys* newKeys();
+        Split* newSplit(Keys* keys, Keys* lower, Block* sibling, Block* succ);
+
+        Block* head;
+        Block* tail;
+
+        std::atomic<int> maxLevel;     //The highest level of a block
+
+        SizeClasses<Reclamation, BlockTowers, Threads, 3, 2, 4, BLOCK_MAX_LEVEL + 1> hazard;
+        typename Reclaimer<Reclamation, Keys, Threads, 1>::type keysHazard;
+        typename Reclaimer<Reclamation, Split, Threads, 1>::type splitsHazard;
+};
+
+template<typename T, int Threads, typename Reclamation>
+Block* UnrolledSkipList<T, Threads, Reclamation>::newBlock(int key, int height, Keys* keys){
+    Block* block = hazard.getFreeNode(height + 1);
+
+    block->key = key;
+    block->topLevel = height;
+    block->keys = keys;
+    block->linked = false;
+
+    std::fill(block->next(), block->next() + height + 1, nullptr);
+
+    return block;
+}
+
+template<typename T, int Threads, typename Reclamation>
+Keys* UnrolledSkipList<T, Threads, Reclamation>::newKeys(){
+    return keysHazard.getFreeNode();
+}
+
+template<typename T, int Threads, typename Reclamation>
+Split* UnrolledSkipList<T, Threads, Reclamation>::newSplit(Keys* keys, Keys* lower, Block* sibling, Block* succ){
+    Split* split = splitsHazard.getFreeNode();
+
+    split->keys = keys;
+    split->lower = lower;
+    split->sibling = sibling;
+    split->succ = succ;
+    split->state.store(PENDING);
+
+    return split;
+}
+
+template<typename T, int Threads, typename Reclamation>
+UnrolledSkipList<T, Threads, Reclamation>::UnrolledSkipList() : maxLevel(0) {
+    Keys* keys = newKeys();
+    std::fill(keys->values, keys->values + BLOCK_KEYS, std::numeric_limits<int>::max());
+
+    head = newBlock(std::numeric_limits<int>::min(), BLOCK_MAX_LEVEL, keys);
+    head->linked = true;
+
+    //The tail never holds any key
+    tail = newBlock(std::numeric_limits<int>::max(), BLOCK_MAX_LEVEL, nullptr);
+
+    for(int i = 0; i < BLOCK_MAX_LEVEL + 1; ++i){
+        head->next()[i] = tail;
+    }
+}
+
+template<typename T, int Threads, typename Reclamation>
+UnrolledSkipList<T, Threads, Reclamation>::~UnrolledSkipList(){
+    keysHazard.releaseNode(Unfreeze(head->keys));
+
+    hazard.releaseNode(tail);
+    hazard.releaseNode(head);
+}
+
+template<typename T, int Threads, typename Reclamation>
+ReclamationStats UnrolledSkipList<T, Threads, Reclamation>::reclamation_stats(){
+    ReclamationStats stats = hazard.stats();
+    stats += keysHazard.stats();
+    stats += splitsHazard.stats();
+
+    return stats;
+}
+
+template<typename T, int Threads, typename Reclamation>
+int UnrolledSkipList<T, Threads, Reclamation>::randomLevel(){
+    return __builtin_ctzl(thread_random() | (1ul << BLOCK_MAX_LEVEL));
+}
+
+template<typename T, int Threads, typename Reclamation>
+bool UnrolledSkipList<T, Threads, Reclamation>::add(T value){
+    CriticalSection<decltype(hazard)> critical(hazard);
+    CriticalSection<decltype(keysHazard)> keysCritical(keysHazard);
+    CriticalSection<decltype(splitsHazard)> splitsCritical(splitsHazard);
+
+    int key = hash(value);
+
+    Block* preds[BLOCK_MAX_LEVEL + 1];
+    Block* succs[BLOCK_MAX_LEVEL + 1];
+
+    while(true){
+        Keys* keys = nullptr;
+        Block* block = locate(key, keys, preds, succs);
+
+        if(!keys){
+            //The block is removed, the key now belongs to its predecessor
+            unlink(block);
+
+            continue;
+        }
+
+        if(IsFrozen(keys)){
+            //The block is being split, the key may belong to the new block once it is done
+            helpSplit(block, AsSplit(keys));
+
+            continue;
+        }
+
+        //The key may be greater than all the keys of a full block, its index is then past the array
+        unsigned int index = rank(keys, key);
+
+        if(index < size(keys) && keys->values[index] == key){
+            hazard.releaseAll();
+            keysHazard.releaseAll();
+            splitsHazard.releaseAll();
+
+            return false;
+        }
+
+        if(size(keys) == BLOCK_KEYS){
+            if(split(block, keys, key)){
+                return true;
+            }
+
+            continue;
+        }
+
+        Keys* copy = newKeys();
+
+        std::copy(keys->values, keys->values + index, copy->values);
+        copy->values[index] = key;
+        std::copy(keys->values + index, keys->values + BLOCK_KEYS - 1, copy->values + index + 1);
+
+        if(CASPTR(&block->keys, keys, copy)){
+            hazard.releaseAll();
+            keysHazard.releaseAll();
+            splitsHazard.releaseAll();
+
+            keysHazard.releaseNode(keys);
+
+            return true;
+        }
+
+        keysHazard.releaseNode(copy);
+    }
+}
+
+template<typename T, int Threads, typename Reclamation>
+bool UnrolledSkipList<T, Threads, Reclamation>::remove(T value){
+    CriticalSection<decltype(hazard)> critical(hazard);
+    CriticalSection<decltype(keysHazard)> keysCritical(keysHazard);
+    CriticalSection<decltype(splitsHazard)> splitsCritical(splitsHazard);
+
+    int key = hash(value);
+
+    Block* preds[BLOCK_MAX_LEVEL + 1];
+    Block* succs[BLOCK_MAX_LEVEL + 1];
+
+    while(true){
+        Keys* keys = nullptr;
+        Block* block = locate(key, keys, preds, succs);
+
+        if(!keys){
+            unlink(block);
+
+            continue;
+        }
+
+        if(IsFrozen(keys)){
+            helpSplit(block, AsSplit(keys));
+
+            continue;
+        }
+
+        unsigned int index = rank(keys, key);
+
+        if(index >= size(keys) || keys->values[index] != key){
+            hazard.releaseAll();
+            keysHazard.releaseAll();
+            splitsHazard.releaseAll();
+
+            return false;
+        }
+
+        //The last key of a block removes the block, except for the head and a block still being linked
+        if(size(keys) == 1 && block != head && block->linked){
+            if(CASPTR(&block->keys, keys, static_cast<Keys*>(nullptr))){
+                keysHazard.releaseAll();
+                splitsHazard.releaseAll();
+                keysHazard.releaseNode(keys);
+
+                unlink(block);
+                hazard.releaseAll();
+
+                hazard.releaseNode(block);
+
+                return true;
+            }
+
+            continue;
+        }
+
+        Keys* copy = newKeys();
+
+        std::copy(keys->values, keys->values + index, copy->values);
+        std::copy(keys->values + index + 1, keys->values + BLOCK_KEYS, copy->values + index);
+        copy->values[BLOCK_KEYS - 1] = std::numeric_limits<int>::max();
+
+        if(CASPTR(&block->keys, keys, copy)){
+            hazard.releaseAll();
+            keysHazard.releaseAll();
+            splitsHazard.releaseAll();
+
+            keysHazard.releaseNode(keys);
+
+            return true;
+        }
+
+        keysHazard.releaseNode(copy);
+    }
+}
+
+template<typename T, int Threads, typename Reclamation>
+bool UnrolledSkipList<T, Threads, Reclamation>::contains(T value){
+    CriticalSection<decltype(hazard)> critical(hazard);
+    CriticalSection<decltype(keysHazard)> keysCritical(keysHazard);
+    CriticalSection<decltype(splitsHazard)> splitsCritical(splitsHazard);
+
+    int key = hash(value);
+
+    Block* preds[BLOCK_MAX_LEVEL + 1];
+    Block* succs[BLOCK_MAX_LEVEL + 1];
+
+    Keys* keys = nullptr;
+    locate(key, keys, preds, succs);
+    keys = Unfreeze(keys);
+
+    //A removed block is empty, the frozen keys of a block being split are still its keys
+    bool found = false;
+    if(keys){
+        unsigned int index = rank(keys, key);
+        found = index < size(keys) && keys->values[index] == key;
+    }
+
+    hazard.releaseAll();
+    keysHazard.releaseAll();
+    splitsHazard.releaseAll();
+
+    return found;
+}
+
+template<typename T, int Threads, typename Reclamation>
+template<typename Functor>
+void UnrolledSkipList<T, Threads, Reclamation>::for_each_in_range(T lo, T hi, Functor functor){
+    CriticalSection<decltype(hazard)> critical(hazard);
+    CriticalSection<decltype(keysHazard)> keysCritical(keysHazard);
+    CriticalSection<decltype(splitsHazard)> splitsCritical(splitsHazard);
+
+    int from = hash(lo);
+    int to = hash(hi);
+
+    Block* preds[BLOCK_MAX_LEVEL + 1];
+    Block* succs[BLOCK_MAX_LEVEL + 1];
+
+    Keys* keys = nullptr;
+    Block* block = locate(from, keys, preds, succs);
+    hazard.publish(block, 0);
+
+    while(true){
+        //The keys below from have already been seen, in this block or in the block it has been split from
+        Keys* current = Unfreeze(keys);
+        if(current){
+            //The padding is not part of the keys, even when the range goes up to the maximal key
+            unsigned int count = size(current);
+
+            for(unsigned int i = rank(current, from); i < count && current->values[i] <= to; ++i){
+                functor(current->values[i]);
+
+                from = current->values[i] + 1;
+            }
+        }
+
+        Block* next = block->next()[0];
+
+        if(IsMarked(next) || finishSplit(block, next)){
+            //The block has been removed or split, go back after the last key seen
+            block = locate(from, keys, preds, succs);
+            hazard.publish(block, 0);
+
+            continue;
+        }
+
+        hazard.publish(next, 1);
+
+        if(block->next()[0] != next){
+            continue;
+        }
+
+        if(next == tail || next->key > to){
+            break;
+        }
+
+        block = next;
+        hazard.publish(block, 0);
+
+        keys = protectKeys(block);
+    }
+
+    hazard.releaseAll();
+    keysHazard.releaseAll();
+    splitsHazard.releaseAll();
+}
+
+template<typename T, int Threads, typename Reclamation>
+unsigned int UnrolledSkipList<T, Threads, Reclamation>::count_range(T lo, T hi){
+    unsigned int count = 0;
+
+    for_each_in_range(lo, hi, [&count](int /*key*/){ ++count; });
+
+    return count;
+}
+
+template<typename T, int Threads, typename Reclamation>
+Block* UnrolledSkipList<T, Threads, Reclamation>::locate(int key, Keys*& keys, Block** preds, Block** succs){
+    while(true){
+        Block* block = find(key, preds, succs, 0) ? succs[0] : preds[0];
+
+        keys = protectKeys(block);
+
+        //A split links the new block before it replaces the keys, if the block has been split 
+        //after the search, the upper part of its range may belong to the new block
+        if(block == succs[0] || block->next()[0] == succs[0]){
+            return block;
+        }
+    }
+}
+
+template<typename T, int Threads, typename Reclamation>
+Keys* UnrolledSkipList<T, Threads, Reclamation>::protectKeys(Block* block){
+    while(true){
+        Keys* keys = block->keys;
+
+        //The frozen keys are only released once the split has replaced them
+        if(IsFrozen(keys)){
+            splitsHazard.publish(AsSplit(keys), 0);
+
+            if(block->keys != keys){
+                continue;
+            }
+        }
+
+        keysHazard.publish(Unfreeze(keys), 0);
+
+        if(block->keys == keys){
+            return keys;
+        }
+    }
+}
+
+template<typename T, int Threads, typename Reclamation>
+bool UnrolledSkipList<T, Threads, Reclamation>::split(Block* block, Keys* keys, int key){
+    Block* succ = block->next()[0];
+
+    //The block is removed or another split of the block is not finished
+    if(IsMarked(succ) || finishSplit(block, succ)){
+        return false;
+    }
+
+    Keys* lower = newKeys();
+    Keys* upper = newKeys();
+
+    const int half = BLOCK_KEYS / 2;
+    int* middle = keys->values + half;
+
+    std::fill(lower->values, lower->values + BLOCK_KEYS, std::numeric_limits<int>::max());
+    std::fill(upper->values, upper->values + BLOCK_KEYS, std::numeric_limits<int>::max());
+
+    std::copy(keys->values, middle, lower->values);
+    std::copy(middle, keys->values + BLOCK_KEYS, upper->values);
+
+    //The new block starts at the middle key, the key is added to the half of its range
+    //Each half only holds BLOCK_KEYS / 2 keys, there is always room after the index of the key
+    Keys* halfKeys = key < *middle ? lower : upper;
+    unsigned int index = std::min(rank(halfKeys, key), size(halfKeys));
+    std::copy_backward(halfKeys->values + index, halfKeys->values + BLOCK_KEYS - 1, halfKeys->values + BLOCK_KEYS);
+    halfKeys->values[index] = key;
+
+    //The successor cannot be unlinked from the block while the split is announced, the new block is linked before it
+    Block* sibling = newBlock(*middle, randomLevel(), upper);
+    sibling->next()[0] = succ;
+
+    Split* split = newSplit(keys, lower, sibling, succ);
+
+    if(!CASPTR(&block->next()[0], succ, Splitting(split))){
+        splitsHazard.releaseNode(split);
+        keysHazard.releaseNode(lower);
+        keysHazard.releaseNode(upper);
+        hazard.releaseNode(sibling);
+
+        return false;
+    }
+
+    //The keys stay protected by this thread until the split is finished, the helpers rely on it
+    bool done = helpSplit(block, split);
+
+    hazard.releaseAll();
+    keysHazard.releaseAll();
+    splitsHazard.releaseAll();
+
+    splitsHazard.releaseNode(split);
+
+    if(!done){
+        keysHazard.releaseNode(lower);
+        keysHazard.releaseNode(upper);
+        hazard.releaseNode(sibling);
+
+        return false;
+    }
+
+    keysHazard.releaseNode(keys);
+
+    link(sibling);
+
+    return true;
+}
+
+template<typename T, int Threads, typename Reclamation>
+bool UnrolledSkipList<T, Threads, Reclamation>::helpSplit(Block* block, Split* split){
+    Keys* frozen = Freeze(split);
+
+    //The keys cannot be released and reused while the split is pending, the thread splitting the block protects them
+    keysHazard.publish(split->keys, 0);
+
+    while(split->state.load() == PENDING){
+        Keys* keys = block->keys;
+
+        if(keys == split->keys){
+            CASPTR(&block->keys, keys, frozen);
+        } else {
+            //Once frozen, the keys are only replaced after the split is decided
+            int expected = PENDING;
+            split->state.compare_exchange_strong(expected, keys == frozen ? FROZEN : ABORTED);
+        }
+    }
+
+    if(split->state.load() == FROZEN){
+        //The new block takes the upper keys before the block loses them
+        CASPTR(&block->next()[0], Splitting(split), split->sibling);
+        CASPTR(&block->keys, frozen, split->lower);
+
+        return true;
+    }
+
+    CASPTR(&block->next()[0], Splitting(split), split->succ);
+
+    return false;
+}
+
+template<typename T, int Threads, typename Reclamation>
+bool UnrolledSkipList<T, Threads, Reclamation>::finishSplit(Block* block, Block* next){
+    if(!IsSplitting(next)){
+        return false;
+    }
+
+    Split* split = AsSplit(next);
+    splitsHazard.publish(split, 0);
+
+    if(block->next()[0] == next){
+        helpSplit(block, split);
+    }
+
+    return true;
+}
+
+template<typename T, int Threads, typename Reclamation>
+void UnrolledSkipList<T, Threads, Reclamation>::link(Block* block){
+    Block* preds[BLOCK_MAX_LEVEL + 1];
+    Block* succs[BLOCK_MAX_LEVEL + 1];
+
+    int top = block->topLevel;
+
+    //The searches start from the highest level, it must be raised before the block is linked on it
+    int highest = maxLevel.load();
+    while(highest < top && !maxLevel.compare_exchange_weak(highest, top));
+
+    if(top > 0){
+        find(block->key, preds, succs, top);
+
+        for(int level = 1; level <= top; ++level){
+            while(true){
+                block->next()[level] = succs[level];
+
+                if(CASPTR(&preds[level]->next()[level], succs[level], block)){
+                    break;
+                } else {
+                    find(block->key, preds, succs, top);
+                }
+            }
+        }
+
+        hazard.releaseAll();
+    }
+
+    //Nobody else removes a block before this point, the levels cannot be marked before
+    block->linked = true;
+}
+
+template<typename T, int Threads, typename Reclamation>
+void UnrolledSkipList<T, Threads, Reclamation>::unlink(Block* block){
+    for(int level = block->topLevel; level >= 0; --level){
+        while(true){
+            Block* succ = block->next()[level];
+
+            //A split announced before the removal is aborted, the block gets its successor back
+            if(finishSplit(block, succ)){
+                continue;
+            }
+
+            if(IsMarked(succ) || CASPTR(&block->next()[level], succ, Mark(succ))){
+                break;
+            }
+        }
+    }
+
+    Block* preds[BLOCK_MAX_LEVEL + 1];
+    Block* succs[BLOCK_MAX_LEVEL + 1];
+
+    //All the levels of the block must be unlinked before it is released
+    find(block->key, preds, succs, block->topLevel);
+}
+
+template<typename T, int Threads, typename Reclamation>
+bool UnrolledSkipList<T, Threads, Reclamation>::find(int key, Block** preds, Block** succs, int height){
+    Block* pred = nullptr;
+    Block* curr = nullptr;
+    Block* succ = nullptr;
+
+    int top = 0;
+
+retry:
+    hazard.releaseAll();
+
+    pred = head;
+    hazard.publish(pred, 0);
+
+    top = std::max(maxLevel.load(std::memory_order_relaxed), height);
+
+    //Each reference is only protected if it is still linked after being published
+    for(int level = top; level >= 0; --level){
+        curr = pred->next()[level];
+
+        //The splits are finished by the searches, a block and its successor are then always adjacent
+        if(finishSplit(pred, curr)){
+            goto retry;
+        }
+
+        hazard.publish(curr, 1);
+
+        if(pred->next()[level] != curr){
+            goto retry;
+        }
+
+        while(true){
+            if(IsMarked(curr)){
+                goto retry;
+            }
+
+            succ = curr->next()[level];
+
+            if(finishSplit(curr, succ)){
+                goto retry;
+            }
+
+            hazard.publish(Unmark(succ), 2);
+
+            if(curr->next()[level] != succ){
+                goto retry;
+            }
+
+            while(IsMarked(succ)){
+                if(!CASPTR(&pred->next()[level], curr, Unmark(succ))){
+                    goto retry;
+                }
+
+                curr = pred->next()[level];
+
+                if(finishSplit(pred, curr)){
+                    goto retry;
+                }
+
+                hazard.publish(curr, 1);
+
+                if(pred->next()[level] != curr || IsMarked(curr)){
+                    goto retry;
+                }
+
+                succ = curr->next()[level];
+
+                if(finishSplit(curr, succ)){
+                    goto retry;
+                }
+
+                hazard.publish(Unmark(succ), 2);
+
+                if(curr->next()[level] != succ){
+                    goto retry;
+                }
+            }
+
+            if(curr->key < key){
+                pred = curr;
+                hazard.publish(pred, 0);
+
+                curr = succ;
+                hazard.publish(curr, 1);
+            } else {
+                break;
+            }
+        }
+
+        preds[level] = pred;
+        succs[level] = curr;
+    }
+
+    bool found = curr->key == key;
+
+    //The predecessor and the successor on the lowest level stay protected
+    hazard.release(2);
+
+    return found;
+}
+
+}
+
+#endif
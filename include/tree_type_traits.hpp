@@ -2,6 +2,7 @@
 #define TREE_TYPE_TRAITS
 
 #include "nbbst/NBBST.hpp"
+#include "nmbst/NMBST.hpp"
 #include "lfmst/MultiwaySearchTree.hpp"
 
 template<typename Tree>
@@ -9,8 +10,13 @@ struct tree_type_traits {
     static const bool balanced = true;
 };
 
-template<typename T, int Threads>
-struct tree_type_traits<nbbst::NBBST<T, Threads>> {
+template<typename T, int Threads, typename Reclamation>
+struct tree_type_traits<nbbst::NBBST<T, Threads, Reclamation>> {
+    static const bool balanced = false;
+};
+
+template<typename T, int Threads, typename Reclamation>
+struct tree_type_traits<nmbst::NMBST<T, Threads, Reclamation>> {
     static const bool balanced = false;
 };
 
@@ -1,3 +1,96 @@
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/membarrier.h>
+
 #include "HazardManager.hpp"
+#include "NodeLock.hpp"
+#include "Numa.hpp"
+
+static bool register_membarrier(){
+#ifdef SYMMETRIC_FENCES
+    return false;
+#else
+    long commands = syscall(__NR_membarrier, MEMBARRIER_CMD_QUERY, 0);
+
+    if(commands < 0 || !(commands & MEMBARRIER_CMD_PRIVATE_EXPEDITED)){
+        return false;
+    }
+
+    return syscall(__NR_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0) == 0;
+#endif
+}
+
+extern const bool asymmetric_fences = register_membarrier();
+
+bool background_reclamation = false;
+
+void heavy_fence(){
+    syscall(__NR_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0);
+}
+
+ReclamationHelper& ReclamationHelper::instance(){
+    //Destroyed after all the managers created after it, so after all the managers using it
+    static ReclamationHelper helper;
+
+    return helper;
+}
+
+ReclamationHelper::ReclamationHelper(){
+    State.store(Running);
+    Stop.store(false);
+
+    Thread = std::thread(&ReclamationHelper::run, this);
+}
+
+ReclamationHelper::~ReclamationHelper(){
+    Stop.store(true);
+    wake();
+
+    Thread.join();
+}
+
+void ReclamationHelper::add(const void* owner, std::function<void()> reclamation){
+    std::lock_guard<std::mutex> guard(Lock);
+
+    Reclamations.push_back(std::make_pair(owner, std::move(reclamation)));
+}
+
+void ReclamationHelper::remove(const void* owner){
+    std::lock_guard<std::mutex> guard(Lock);
+
+    Reclamations.erase(std::remove_if(Reclamations.begin(), Reclamations.end(),
+        [owner](const std::pair<const void*, std::function<void()>>& reclamation){ return reclamation.first == owner; }),
+        Reclamations.end());
+}
+
+void ReclamationHelper::wake(){
+    //Only the first wake-up after a run writes the word
+    if(State.load() != Woken && State.exchange(Woken) == Parked){
+        futex_wake_all(&State);
+    }
+}
+
+void ReclamationHelper::run(){
+    //The free nodes are given to the pool of the node of the helper
+    thread_node = current_numa_node();
+
+    while(!Stop.load()){
+        //The wake-ups from now on are seen after the run
+        State.store(Running);
+
+        {
+            std::lock_guard<std::mutex> guard(Lock);
+
+            for(auto& reclamation : Reclamations){
+                reclamation.second();
+            }
+        }
+
+        //Park only if nobody woke the helper up during the run
+        int running = Running;
 
-__thread unsigned int thread_num;
+        if(State.compare_exchange_strong(running, Parked)){
+            futex_wait(&State, Parked);
+        }
+    }
+}
@@ -0,0 +1,99 @@
+#include <sched.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+#include <cstdio>
+#include <cstring>
+
+#include "Numa.hpp"
+
+__thread unsigned int thread_node;
+
+static unsigned int count_nodes(){
+    unsigned int first = 0;
+    unsigned int last = 0;
+
+    FILE* file = fopen("/sys/devices/system/node/possible", "r");
+
+    if(!file){
+        return 1;
+    }
+
+    //The nodes are given as a range ("0-1") or as a single node ("0")
+    int read = fscanf(file, "%u-%u", &first, &last);
+    fclose(file);
+
+    if(read == 2){
+        return last + 1;
+    } else if(read == 1){
+        return first + 1;
+    }
+
+    return 1;
+}
+
+unsigned int numa_nodes(){
+    static const unsigned int nodes = count_nodes();
+
+    return nodes;
+}
+
+unsigned int numa_node_of_cpu(unsigned int cpu){
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u", cpu);
+
+    DIR* directory = opendir(path);
+
+    if(!directory){
+        return 0;
+    }
+
+    unsigned int node = 0;
+
+    //The directory of a CPU holds a link to its node, named nodeN
+    while(struct dirent* entry = readdir(directory)){
+        if(strncmp(entry->d_name, "node", 4) == 0 && sscanf(entry->d_name + 4, "%u", &node) == 1){
+            break;
+        }
+    }
+
+    closedir(directory);
+
+    return node;
+}
+
+unsigned int current_numa_node(){
+    unsigned int cpu = 0;
+    unsigned int node = 0;
+
+    if(syscall(SYS_getcpu, &cpu, &node, nullptr) != 0){
+        return 0;
+    }
+
+    return node;
+}
+
+bool pin_thread(unsigned int cpu){
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+
+    if(sched_setaffinity(0, sizeof(set), &set) != 0){
+        return false;
+    }
+
+    thread_node = numa_node_of_cpu(cpu);
+
+    return true;
+}
+
+void bind_to_node(void* memory, std::size_t bytes, unsigned int node){
+    unsigned long mask = 1ul << node;
+
+    //The kernel only reads maxnode - 1 bits of the mask
+    if(numa_nodes() > 1 && node < 8 * sizeof(mask)){
+        syscall(SYS_mbind, memory, bytes, MPOL_PREFERRED, &mask, 8 * sizeof(mask) + 1, 0);
+    }
+}
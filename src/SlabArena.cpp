@@ -0,0 +1,175 @@
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <map>
+#include <vector>
+#include <mutex>
+
+#include "SlabArena.hpp"
+#include "Numa.hpp"
+
+unsigned int default_high_water = 0;
+
+bool huge_slabs = false;
+
+std::atomic<std::size_t> slab_bytes(0);
+
+static const std::size_t page_size = sysconf(_SC_PAGESIZE);
+
+static const std::size_t huge_page_size = 2 * 1024 * 1024;
+
+//Map memory aligned on the given size
+static char* map_aligned(std::size_t bytes){
+    //Map twice the size to be able to align the memory, then unmap the excess on both sides
+    char* memory = static_cast<char*>(mmap(nullptr, 2 * bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+
+    if(memory == MAP_FAILED){
+        throw std::bad_alloc();
+    }
+
+    char* aligned = reinterpret_cast<char*>((reinterpret_cast<std::uintptr_t>(memory) + bytes - 1) & ~(bytes - 1));
+
+    if(aligned > memory){
+        munmap(memory, aligned - memory);
+    }
+
+    if(aligned + bytes < memory + 2 * bytes){
+        munmap(aligned + bytes, memory + 2 * bytes - (aligned + bytes));
+    }
+
+    return aligned;
+}
+
+//Map a huge page of the given NUMA node, reserved with MAP_HUGETLB if possible, otherwise a transparent huge page
+static char* map_huge_page(unsigned int node){
+#ifdef MAP_HUGETLB
+    void* reserved = mmap(nullptr, huge_page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+    //A huge page is always aligned on its size
+    if(reserved != MAP_FAILED){
+        bind_to_node(reserved, huge_page_size, node);
+
+        return static_cast<char*>(reserved);
+    }
+#endif
+
+    char* memory = map_aligned(huge_page_size);
+
+#ifdef MADV_HUGEPAGE
+    madvise(memory, huge_page_size, MADV_HUGEPAGE);
+#endif
+
+    bind_to_node(memory, huge_page_size, node);
+
+    return memory;
+}
+
+/*
+ * The huge pages are never given back to the system, the slabs carved from them
+ * are kept in free lists by NUMA node and by size to be carved again by the next arenas.
+ */
+
+struct HugePages {
+    char* current;                                          //The huge page being carved
+    std::size_t used;
+    std::map<std::size_t, std::vector<void*>> free_slabs;
+
+    HugePages() : current(nullptr), used(huge_page_size) {}
+};
+
+static std::mutex huge_lock;
+static std::map<unsigned int, HugePages> huge_pages;       //By NUMA node
+static std::map<char*, unsigned int> huge_nodes;           //The NUMA node of each huge page
+
+static void* map_huge_slab(std::size_t bytes){
+    std::lock_guard<std::mutex> lock(huge_lock);
+
+    unsigned int node = thread_node;
+    HugePages& pages = huge_pages[node];
+
+    std::vector<void*>& free_slabs = pages.free_slabs[bytes];
+
+    if(!free_slabs.empty()){
+        void* slab = free_slabs.back();
+        free_slabs.pop_back();
+
+        //Like a new mapping, the slab is filled with zeroes
+        memset(slab, 0, bytes);
+
+        return slab;
+    }
+
+    //The slabs are powers of two, carving them in order from an aligned page keeps them aligned
+    pages.used = (pages.used + bytes - 1) & ~(bytes - 1);
+
+    if(pages.used + bytes > huge_page_size){
+        pages.current = map_huge_page(node);
+        pages.used = 0;
+
+        huge_nodes[pages.current] = node;
+
+        slab_bytes += huge_page_size;
+    }
+
+    void* slab = pages.current + pages.used;
+    pages.used += bytes;
+
+    return slab;
+}
+
+void* map_slab(std::size_t bytes, bool huge){
+    if(huge && bytes <= huge_page_size){
+        return map_huge_slab(bytes);
+    }
+
+    //No binding, each page of cells is first touched by the owner of the arena when it carves
+    //them, so it is placed on the node of the owner, even if another thread maps the slab
+    void* slab = map_aligned(bytes);
+
+    slab_bytes += bytes;
+
+    return slab;
+}
+
+void unmap_slab(void* slab, std::size_t bytes, bool huge){
+    if(huge && bytes <= huge_page_size){
+        std::lock_guard<std::mutex> lock(huge_lock);
+
+        char* page = reinterpret_cast<char*>(reinterpret_cast<std::uintptr_t>(slab) & ~(huge_page_size - 1));
+        huge_pages[huge_nodes[page]].free_slabs[bytes].push_back(slab);
+
+        return;
+    }
+
+    munmap(slab, bytes);
+
+    slab_bytes -= bytes;
+}
+
+//Return the number of bytes of the pages fully contained in the memory and set begin to the first one
+static std::size_t whole_pages(void* memory, std::size_t bytes, char*& begin){
+    std::uintptr_t first = (reinterpret_cast<std::uintptr_t>(memory) + page_size - 1) & ~(page_size - 1);
+    std::uintptr_t last = (reinterpret_cast<std::uintptr_t>(memory) + bytes) & ~(page_size - 1);
+
+    begin = reinterpret_cast<char*>(first);
+
+    return last > first ? last - first : 0;
+}
+
+void release_pages(void* memory, std::size_t bytes){
+    char* begin;
+    std::size_t pages = whole_pages(memory, bytes, begin);
+
+    if(pages){
+        madvise(begin, pages, MADV_DONTNEED);
+
+        slab_bytes -= pages;
+    }
+}
+
+void reuse_pages(void* memory, std::size_t bytes){
+    char* begin;
+
+    slab_bytes += whole_pages(memory, bytes, begin);
+}
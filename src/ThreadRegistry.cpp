@@ -0,0 +1,48 @@
+#include <chrono>
+
+#include "ThreadRegistry.hpp"
+#include "Numa.hpp"
+
+__thread unsigned int thread_num;
+
+//Never zero, the generator of a thread not attached still works
+__thread unsigned long thread_random_state = 0x9E3779B97F4A7C15ul;
+
+//Indicates for each slot if a thread is attached to it
+static ThreadTable<std::atomic<bool>> attached(32);
+
+static std::atomic<unsigned int> slots(0);
+
+unsigned int thread_attach(){
+    unsigned int slot = 0;
+
+    while(attached[slot].load() || attached[slot].exchange(true)){
+        ++slot;
+    }
+
+    unsigned int used = slots.load();
+    while(used <= slot && !slots.compare_exchange_weak(used, slot + 1)){
+        //used is updated by the CAS
+    }
+
+    thread_num = slot;
+    thread_node = current_numa_node();
+
+    //Mix the time and the slot (splitmix64), so that the threads attached at the same time get unrelated sequences
+    unsigned long seed = std::chrono::high_resolution_clock::now().time_since_epoch().count() + (slot + 1) * 0x9E3779B97F4A7C15ul;
+    seed = (seed ^ (seed >> 30)) * 0xBF58476D1CE4E5B9ul;
+    seed = (seed ^ (seed >> 27)) * 0x94D049BB133111EBul;
+    seed ^= seed >> 31;
+
+    thread_random_state = seed ? seed : 1;
+
+    return slot;
+}
+
+void thread_detach(){
+    attached[thread_num].store(false);
+}
+
+unsigned int thread_slots(){
+    return slots.load();
+}
@@ -4,17 +4,29 @@
 #include <chrono>
 #include <thread>
 #include <atomic>
+#include <mutex>
 #include <set>
 #include <vector>
 
+#include <signal.h>
+#include <time.h>
+
 #include "bench.hpp"
 #include "file_distribution.hpp"
-#include "HazardManager.hpp"    //To manipulate thread_num
+#include "ThreadRegistry.hpp"   //To attach the threads
+#include "HazardManager.hpp"
+#include "EpochManager.hpp"
+#include "IntervalManager.hpp"
+#include "SlabArena.hpp"        //To select the pages of the nodes
+#include "Numa.hpp"             //To pin the threads
 #include "Results.hpp"          //To generate the graphs data
 
 //Include all the trees implementations
 #include "skiplist/SkipList.hpp"
+#include "skiplist/UnrolledSkipList.hpp"
 #include "nbbst/NBBST.hpp"
+#include "nmbst/NMBST.hpp"
+#include "chromatic/ChromaticTree.hpp"
 #include "avltree/AVLTree.hpp"
 #include "lfmst/MultiwaySearchTree.hpp"
 #include "cbtree/CBTree.hpp"
@@ -23,14 +35,28 @@
 #define OPERATIONS 1000000
 #define REPEAT 2
 #define SEARCH_BENCH_OPERATIONS 100000 
+#define HAZARD_BENCH_NODES 1024
+#define LATENCY_BENCH_OPERATIONS 200000
 
 //Chrono typedefs
 typedef std::chrono::high_resolution_clock Clock;
 typedef std::chrono::milliseconds milliseconds;
 typedef std::chrono::microseconds microseconds;
+typedef std::chrono::nanoseconds nanoseconds;
+
+/*!
+ * Pin the calling thread on the CPU of the given thread in the given placement, if any. 
+ * \param cpus The CPUs of the placement, in the order of the threads, empty to not pin the threads. 
+ * \param tid The index of the thread in the benchmark. 
+ */
+void place_thread(const std::vector<unsigned int>& cpus, unsigned int tid){
+    if(!cpus.empty()){
+        pin_thread(cpus[tid % cpus.size()]);
+    }
+}
 
 template<typename Tree, unsigned int Threads>
-void random_bench(const std::string& name, unsigned int range, unsigned int add, unsigned int remove, Results& results){
+void random_bench(const std::string& name, unsigned int range, unsigned int add, unsigned int remove, Results& results, const std::vector<unsigned int>& cpus = std::vector<unsigned int>()){
     Tree tree;
 
     Clock::time_point t0 = Clock::now();
@@ -39,8 +65,9 @@ void random_bench(const std::string& name, unsigned int range, unsigned int add,
     
     std::vector<std::thread> pool;
     for(unsigned int tid = 0; tid < Threads; ++tid){
-        pool.push_back(std::thread([&tree, &elements, range, add, remove, tid](){
-            thread_num = tid;
+        pool.push_back(std::thread([&tree, &elements, &cpus, range, add, remove, tid](){
+            place_thread(cpus, tid);
+            thread_attach();
 
             std::mt19937_64 engine(time(0) + tid);
 
@@ -56,7 +83,7 @@ void random_bench(const std::string& name, unsigned int range, unsigned int add,
 
                 if(op < add){
                     if(tree.add(value)){
-                        elements[thread_num].push_back(value);
+                        elements[tid].push_back(value);
                     }
                 } else if(op < (add + remove)){
                     tree.remove(value);
@@ -64,6 +91,8 @@ void random_bench(const std::string& name, unsigned int range, unsigned int add,
                     tree.contains(i);
                 }
             }
+
+            thread_detach();
         }));
     }
 
@@ -75,17 +104,21 @@ void random_bench(const std::string& name, unsigned int range, unsigned int add,
     unsigned long throughput = (Threads * OPERATIONS) / ms.count();
 
     std::cout << name << " througput with " << Threads << " threads = " << throughput << " operations / ms" << std::endl;
+    std::cout << name << " reclamation with " << Threads << " threads: " << tree.reclamation_stats() << std::endl;
 
     results.add_result(name, throughput);
 
     pool.clear();
     for(unsigned int tid = 0; tid < Threads; ++tid){
-        pool.push_back(std::thread([&tree, &elements, tid](){
-            thread_num = tid;
+        pool.push_back(std::thread([&tree, &elements, &cpus, tid](){
+            place_thread(cpus, tid);
+            thread_attach();
 
-            for(auto i : elements[thread_num]){
+            for(auto i : elements[tid]){
                 tree.remove(i);
             }
+
+            thread_detach();
         }));
     }
 
@@ -101,6 +134,15 @@ void random_bench(const std::string& name, unsigned int range, unsigned int add,
     random_bench<type<int, 16>, 16>(name, range, add, remove, results);\
     random_bench<type<int, 32>, 32>(name, range, add, remove, results);
 
+#define BENCH_RECLAMATION(type, reclamation, name, range, add, remove)\
+    random_bench<type<int, 1, reclamation>, 1>(name, range, add, remove, results);\
+    random_bench<type<int, 2, reclamation>, 2>(name, range, add, remove, results);\
+    random_bench<type<int, 3, reclamation>, 3>(name, range, add, remove, results);\
+    random_bench<type<int, 4, reclamation>, 4>(name, range, add, remove, results);\
+    random_bench<type<int, 8, reclamation>, 8>(name, range, add, remove, results);\
+    random_bench<type<int, 16, reclamation>, 16>(name, range, add, remove, results);\
+    random_bench<type<int, 32, reclamation>, 32>(name, range, add, remove, results);
+
 void random_bench(unsigned int range, unsigned int add, unsigned int remove){
     std::cout << "Bench with " << OPERATIONS << " operations/thread, range = " << range << ", " << add << "% add, " << remove << "% remove, " << (100 - add - remove) << "% contains" << std::endl;
 
@@ -113,10 +155,24 @@ void random_bench(unsigned int range, unsigned int add, unsigned int remove){
 
     for(int i = 0; i < REPEAT; ++i){
         BENCH(skiplist::SkipList, "skiplist", range, add, remove);
+        BENCH(skiplist::UnrolledSkipList, "unrolled", range, add, remove);
         BENCH(nbbst::NBBST, "nbbst", range, add, remove);
+        BENCH(nmbst::NMBST, "nmbst", range, add, remove);
+        BENCH(chromatic::ChromaticTree, "chromatic", range, add, remove);
         BENCH(avltree::AVLTree, "avltree", range, add, remove)
         BENCH(lfmst::MultiwaySearchTree, "lfmst", range, add, remove);
         BENCH(cbtree::CBTree, "cbtree", range, add, remove);
+
+        //The same structures with Epoch-Based Reclamation instead of Hazard Pointers
+        BENCH_RECLAMATION(skiplist::SkipList, Epochs, "skiplist-epoch", range, add, remove);
+        BENCH_RECLAMATION(nbbst::NBBST, Epochs, "nbbst-epoch", range, add, remove);
+        BENCH_RECLAMATION(avltree::AVLTree, Epochs, "avltree-epoch", range, add, remove);
+        BENCH_RECLAMATION(lfmst::MultiwaySearchTree, Epochs, "lfmst-epoch", range, add, remove);
+        BENCH_RECLAMATION(cbtree::CBTree, Epochs, "cbtree-epoch", range, add, remove);
+
+        //The structures that publish the most references with Interval-Based Reclamation
+        BENCH_RECLAMATION(skiplist::SkipList, Intervals, "skiplist-interval", range, add, remove);
+        BENCH_RECLAMATION(lfmst::MultiwaySearchTree, Intervals, "lfmst-interval", range, add, remove);
     }
 
     results.finish();
@@ -139,6 +195,324 @@ void random_bench(){
     random_bench(std::numeric_limits<int>::max() - 1);      //Key in {0, 2^32}
 }
 
+void insert_bench(){
+    unsigned int range = std::numeric_limits<int>::max() - 1;
+
+    std::cout << "Bench the structures with random levels with " << OPERATIONS << " operations/thread, 90% add, 10% remove" << std::endl;
+
+    Results results;
+    results.start("insert-heavy");
+    results.set_max(7);
+
+    //Each insertion draws a random level, from the generator of its thread
+    for(int i = 0; i < REPEAT; ++i){
+        BENCH(skiplist::SkipList, "skiplist", range, 90, 10);
+        BENCH(lfmst::MultiwaySearchTree, "lfmst", range, 90, 10);
+    }
+
+    results.finish();
+
+    std::cout << "bench is over" << std::endl;
+}
+
+/*!
+ * A std::set protected by a single lock, the way the ordered scans and the priority queues are served 
+ * without support in the structure. 
+ */
+template<typename T, int Threads>
+class LockedSet {
+    public:
+        bool contains(T value){
+            std::lock_guard<std::mutex> guard(lock);
+            return set.count(value);
+        }
+
+        bool add(T value){
+            std::lock_guard<std::mutex> guard(lock);
+            return set.insert(value).second;
+        }
+
+        bool remove(T value){
+            std::lock_guard<std::mutex> guard(lock);
+            return set.erase(value);
+        }
+
+        unsigned int count_range(T lo, T hi){
+            std::lock_guard<std::mutex> guard(lock);
+            return std::distance(set.lower_bound(lo), set.upper_bound(hi));
+        }
+
+        bool pop_min(int& key){
+            std::lock_guard<std::mutex> guard(lock);
+
+            if(set.empty()){
+                return false;
+            }
+
+            key = *set.begin();
+            set.erase(set.begin());
+
+            return true;
+        }
+
+    private:
+        std::mutex lock;
+        std::set<T> set;
+};
+
+template<typename Tree, unsigned int Threads>
+void range_bench(const std::string& name, unsigned int range, unsigned int width, Results& results){
+    Tree tree;
+
+    //Fill half of the range
+    std::mt19937_64 engine(time(0));
+    std::uniform_int_distribution<int> fillDistribution(0, range);
+    for(unsigned int i = 0; i < range / 2; ++i){
+        tree.add(fillDistribution(engine));
+    }
+
+    Clock::time_point t0 = Clock::now();
+
+    std::vector<std::thread> pool;
+    for(unsigned int tid = 0; tid < Threads; ++tid){
+        pool.push_back(std::thread([&tree, range, width, tid](){
+            thread_attach();
+
+            std::mt19937_64 engine(time(0) + tid);
+
+            std::uniform_int_distribution<int> valueDistribution(0, range);
+            auto valueGenerator = std::bind(valueDistribution, engine);
+
+            std::uniform_int_distribution<int> operationDistribution(0, 99);
+            auto operationGenerator = std::bind(operationDistribution, engine);
+
+            for(int i = 0; i < OPERATIONS; ++i){
+                int value = valueGenerator();
+                unsigned int op = operationGenerator();
+
+                if(op < 10){
+                    tree.add(value);
+                } else if(op < 20){
+                    tree.remove(value);
+                } else if(op < 90){
+                    tree.contains(value);
+                } else {
+                    tree.count_range(value, value + width);
+                }
+            }
+
+            thread_detach();
+        }));
+    }
+
+    for_each(pool.begin(), pool.end(), [](std::thread& t){t.join();});
+
+    Clock::time_point t1 = Clock::now();
+
+    milliseconds ms = std::chrono::duration_cast<milliseconds>(t1 - t0);
+    unsigned long throughput = (Threads * OPERATIONS) / ms.count();
+
+    std::cout << name << " througput with " << Threads << " threads = " << throughput << " operations / ms" << std::endl;
+
+    results.add_result(name, throughput);
+}
+
+#define RANGE(type, name, range, width)\
+    range_bench<type<int, 1>, 1>(name, range, width, results);\
+    range_bench<type<int, 2>, 2>(name, range, width, results);\
+    range_bench<type<int, 3>, 3>(name, range, width, results);\
+    range_bench<type<int, 4>, 4>(name, range, width, results);\
+    range_bench<type<int, 8>, 8>(name, range, width, results);\
+    range_bench<type<int, 16>, 16>(name, range, width, results);\
+    range_bench<type<int, 32>, 32>(name, range, width, results);
+
+void range_bench(){
+    unsigned int range = 200000;
+    unsigned int width = 100;
+
+    std::cout << "Bench the range scans with " << OPERATIONS << " operations/thread, 10% add, 10% remove, 70% contains, 10% scans of " << width << " keys" << std::endl;
+
+    Results results;
+    results.start("range-mixed");
+    results.set_max(7);
+
+    for(int i = 0; i < REPEAT; ++i){
+        RANGE(skiplist::SkipList, "skiplist", range, width);
+        RANGE(skiplist::UnrolledSkipList, "unrolled", range, width);
+        RANGE(LockedSet, "locked-set", range, width);
+    }
+
+    results.finish();
+
+    std::cout << "bench is over" << std::endl;
+}
+
+/*!
+ * Placement of the threads of a benchmark on the CPUs. 
+ */
+enum class Placement {
+    Compact,    //The threads fill the CPUs of a NUMA node before using the next node
+    Scatter     //The threads are spread over the NUMA nodes in turn
+};
+
+/*!
+ * Return the CPUs on which the threads are pinned, in the order of the threads. 
+ */
+std::vector<unsigned int> placement_cpus(Placement placement){
+    std::vector<std::vector<unsigned int>> node_cpus(numa_nodes());
+
+    for(unsigned int cpu = 0; cpu < std::thread::hardware_concurrency(); ++cpu){
+        node_cpus[numa_node_of_cpu(cpu) % node_cpus.size()].push_back(cpu);
+    }
+
+    std::vector<unsigned int> cpus;
+
+    if(placement == Placement::Compact){
+        for(auto& node : node_cpus){
+            cpus.insert(cpus.end(), node.begin(), node.end());
+        }
+    } else {
+        for(unsigned int i = 0; cpus.size() < std::thread::hardware_concurrency(); ++i){
+            for(auto& node : node_cpus){
+                if(i < node.size()){
+                    cpus.push_back(node[i]);
+                }
+            }
+        }
+    }
+
+    return cpus;
+}
+
+#define BENCH_PLACEMENT(type, name, cpus, range, add, remove)\
+    random_bench<type<int, 1>, 1>(name, range, add, remove, results, cpus);\
+    random_bench<type<int, 2>, 2>(name, range, add, remove, results, cpus);\
+    random_bench<type<int, 3>, 3>(name, range, add, remove, results, cpus);\
+    random_bench<type<int, 4>, 4>(name, range, add, remove, results, cpus);\
+    random_bench<type<int, 8>, 8>(name, range, add, remove, results, cpus);\
+    random_bench<type<int, 16>, 16>(name, range, add, remove, results, cpus);\
+    random_bench<type<int, 32>, 32>(name, range, add, remove, results, cpus);
+
+void numa_bench(unsigned int range, unsigned int add, unsigned int remove){
+    std::cout << "Bench with " << OPERATIONS << " operations/thread, range = " << range << ", " << add << "% add, " << remove << "% remove, " << (100 - add - remove) << "% contains on " << numa_nodes() << " NUMA nodes" << std::endl;
+
+    std::stringstream bench_name;
+    bench_name << "numa-" << range << "-" << add << "-" << remove;
+
+    std::vector<unsigned int> compact = placement_cpus(Placement::Compact);
+    std::vector<unsigned int> scatter = placement_cpus(Placement::Scatter);
+
+    Results results;
+    results.start(bench_name.str());
+    results.set_max(7);
+
+    for(int i = 0; i < REPEAT; ++i){
+        //The threads are not pinned, then they are pinned node by node and spread over the nodes
+        BENCH(skiplist::SkipList, "skiplist", range, add, remove);
+        BENCH_PLACEMENT(skiplist::SkipList, "skiplist-compact", compact, range, add, remove);
+        BENCH_PLACEMENT(skiplist::SkipList, "skiplist-scatter", scatter, range, add, remove);
+
+        BENCH(nbbst::NBBST, "nbbst", range, add, remove);
+        BENCH_PLACEMENT(nbbst::NBBST, "nbbst-compact", compact, range, add, remove);
+        BENCH_PLACEMENT(nbbst::NBBST, "nbbst-scatter", scatter, range, add, remove);
+
+        BENCH(avltree::AVLTree, "avltree", range, add, remove);
+        BENCH_PLACEMENT(avltree::AVLTree, "avltree-compact", compact, range, add, remove);
+        BENCH_PLACEMENT(avltree::AVLTree, "avltree-scatter", scatter, range, add, remove);
+
+        BENCH(lfmst::MultiwaySearchTree, "lfmst", range, add, remove);
+        BENCH_PLACEMENT(lfmst::MultiwaySearchTree, "lfmst-compact", compact, range, add, remove);
+        BENCH_PLACEMENT(lfmst::MultiwaySearchTree, "lfmst-scatter", scatter, range, add, remove);
+
+        BENCH(cbtree::CBTree, "cbtree", range, add, remove);
+        BENCH_PLACEMENT(cbtree::CBTree, "cbtree-compact", compact, range, add, remove);
+        BENCH_PLACEMENT(cbtree::CBTree, "cbtree-scatter", scatter, range, add, remove);
+    }
+
+    results.finish();
+
+    std::cout << "bench is over" << std::endl;
+}
+
+void numa_bench(){
+    numa_bench(20000, 20, 10);                                  //Key in {0, 20000}
+    numa_bench(std::numeric_limits<int>::max() - 1, 20, 10);    //Key in {0, 2^32}
+}
+
+template<typename Tree, unsigned int Threads>
+void scheduler_bench(const std::string& name, unsigned int size, Results& results){
+    Tree tree;
+
+    //The queue holds about size tasks, each thread pushes a task and pops the most urgent one
+    std::mt19937_64 engine(time(0));
+    std::uniform_int_distribution<int> fillDistribution(0, std::numeric_limits<int>::max() - 1);
+    for(unsigned int i = 0; i < size; ++i){
+        tree.add(fillDistribution(engine));
+    }
+
+    Clock::time_point t0 = Clock::now();
+
+    std::vector<std::thread> pool;
+    for(unsigned int tid = 0; tid < Threads; ++tid){
+        pool.push_back(std::thread([&tree, tid](){
+            thread_attach();
+
+            std::mt19937_64 engine(time(0) + tid);
+
+            std::uniform_int_distribution<int> priorityDistribution(0, std::numeric_limits<int>::max() - 1);
+            auto priorityGenerator = std::bind(priorityDistribution, engine);
+
+            for(int i = 0; i < OPERATIONS / 2; ++i){
+                tree.add(priorityGenerator());
+
+                int priority;
+                tree.pop_min(priority);
+            }
+
+            thread_detach();
+        }));
+    }
+
+    for_each(pool.begin(), pool.end(), [](std::thread& t){t.join();});
+
+    Clock::time_point t1 = Clock::now();
+
+    milliseconds ms = std::chrono::duration_cast<milliseconds>(t1 - t0);
+    unsigned long throughput = (Threads * OPERATIONS) / ms.count();
+
+    std::cout << name << " througput with " << Threads << " threads = " << throughput << " operations / ms" << std::endl;
+
+    results.add_result(name, throughput);
+}
+
+#define SCHEDULER(type, name, size)\
+    scheduler_bench<type<int, 1>, 1>(name, size, results);\
+    scheduler_bench<type<int, 2>, 2>(name, size, results);\
+    scheduler_bench<type<int, 3>, 3>(name, size, results);\
+    scheduler_bench<type<int, 4>, 4>(name, size, results);\
+    scheduler_bench<type<int, 8>, 8>(name, size, results);\
+    scheduler_bench<type<int, 16>, 16>(name, size, results);\
+    scheduler_bench<type<int, 32>, 32>(name, size, results);
+
+void scheduler_bench(){
+    unsigned int size = 10000;
+
+    std::cout << "Bench the priority queues with " << OPERATIONS << " operations/thread, half pushes of a random priority, half pops of the minimum, " << size << " tasks queued" << std::endl;
+
+    Results results;
+    results.start("scheduler");
+    results.set_max(7);
+
+    for(int i = 0; i < REPEAT; ++i){
+        SCHEDULER(skiplist::SkipList, "skiplist", size);
+        SCHEDULER(LockedSet, "locked-set", size);
+    }
+
+    results.finish();
+
+    std::cout << "bench is over" << std::endl;
+}
+
 template<typename Tree, unsigned int Threads>
 void skewed_bench(const std::string& name, unsigned int range, unsigned int add, unsigned int remove, file_distribution<>& distribution, Results& results){
     Tree tree;
@@ -150,7 +524,7 @@ void skewed_bench(const std::string& name, unsigned int range, unsigned int add,
     std::vector<std::thread> pool;
     for(unsigned int tid = 0; tid < Threads; ++tid){
         pool.push_back(std::thread([&tree, &elements, &distribution, range, add, remove, tid](){
-            thread_num = tid;
+            thread_attach();
 
             std::mt19937_64 engine(time(0) + tid);
 
@@ -160,7 +534,7 @@ void skewed_bench(const std::string& name, unsigned int range, unsigned int add,
             for(int i = 0; i < OPERATIONS; ++i){
                 auto value = distribution(engine);
                 if(tree.add(value)){
-                    elements[thread_num].push_back(value);
+                    elements[tid].push_back(value);
                 }
             }
 
@@ -170,7 +544,7 @@ void skewed_bench(const std::string& name, unsigned int range, unsigned int add,
 
                 if(op < add){
                     if(tree.add(value)){
-                        elements[thread_num].push_back(value);
+                        elements[tid].push_back(value);
                     }
                 } else if(op < (add + remove)){
                     tree.remove(value);
@@ -178,6 +552,8 @@ void skewed_bench(const std::string& name, unsigned int range, unsigned int add,
                     tree.contains(i);
                 }
             }
+
+            thread_detach();
         }));
     }
 
@@ -194,11 +570,13 @@ void skewed_bench(const std::string& name, unsigned int range, unsigned int add,
     pool.clear();
     for(unsigned int tid = 0; tid < Threads; ++tid){
         pool.push_back(std::thread([&tree, &elements, tid](){
-            thread_num = tid;
+            thread_attach();
 
-            for(auto i : elements[thread_num]){
+            for(auto i : elements[tid]){
                 tree.remove(i);
             }
+
+            thread_detach();
         }));
     }
 
@@ -210,7 +588,10 @@ void skewed_bench(unsigned int range, unsigned int add, unsigned int remove, fil
 
     for(int i = 0; i < REPEAT; ++i){
         skewed_bench<skiplist::SkipList<int, 8>, 8>("skiplist", range, add, remove, distribution, results);
+        skewed_bench<skiplist::UnrolledSkipList<int, 8>, 8>("unrolled", range, add, remove, distribution, results);
         skewed_bench<nbbst::NBBST<int, 8>, 8>("nbbst", range, add, remove, distribution, results);
+        skewed_bench<nmbst::NMBST<int, 8>, 8>("nmbst", range, add, remove, distribution, results);
+        skewed_bench<chromatic::ChromaticTree<int, 8>, 8>("chromatic", range, add, remove, distribution, results);
         skewed_bench<avltree::AVLTree<int, 8>, 8>("avltree", range, add, remove, distribution, results);
         skewed_bench<lfmst::MultiwaySearchTree<int, 8>, 8>("lfmst", range, add, remove, distribution, results);
         skewed_bench<cbtree::CBTree<int, 8>, 8>("cbtree", range, add, remove, distribution, results);
@@ -286,11 +667,13 @@ void seq_construction_bench(const std::string& name, unsigned int size, Results&
     std::vector<std::thread> pool;
     for(unsigned int tid = 0; tid < Threads; ++tid){
         pool.push_back(std::thread([&tree, part, size, tid](){
-            thread_num = tid;
+            thread_attach();
 
             for(unsigned int i = tid * part; i < (tid + 1) * part; ++i){
                 tree.add(i);
             }
+
+            thread_detach();
         }));
     }
 
@@ -329,7 +712,9 @@ void seq_construction_bench(){
 
         for(int i = 0; i < REPEAT; ++i){
             SEQ_CONSTRUCTION(skiplist::SkipList, "skiplist", size);
+            SEQ_CONSTRUCTION(skiplist::UnrolledSkipList, "unrolled", size);
             SEQ_CONSTRUCTION(nbbst::NBBST, "nbbst", size);
+            SEQ_CONSTRUCTION(chromatic::ChromaticTree, "chromatic", size);
             SEQ_CONSTRUCTION(avltree::AVLTree, "avltree", size);
             SEQ_CONSTRUCTION(lfmst::MultiwaySearchTree, "lfmst", size);
             SEQ_CONSTRUCTION(cbtree::CBTree, "cbtree", size);
@@ -352,7 +737,9 @@ void seq_construction_bench(){
         
         for(int i = 0; i < REPEAT; ++i){
             SEQ_CONSTRUCTION(skiplist::SkipList, "skiplist", size);
+            SEQ_CONSTRUCTION(skiplist::UnrolledSkipList, "unrolled", size);
             //Too slow SEQ_CONSTRUCTION(nbbst::NBBST, "nbbst", size);
+            SEQ_CONSTRUCTION(chromatic::ChromaticTree, "chromatic", size);
             SEQ_CONSTRUCTION(avltree::AVLTree, "avltree", size);
             SEQ_CONSTRUCTION(lfmst::MultiwaySearchTree, "lfmst", size);
             SEQ_CONSTRUCTION(cbtree::CBTree, "cbtree", size);
@@ -382,11 +769,13 @@ void random_construction_bench(const std::string& name, unsigned int size, Resul
     std::vector<std::thread> pool;
     for(unsigned int tid = 0; tid < Threads; ++tid){
         pool.push_back(std::thread([&tree, &elements, part, size, tid](){
-            thread_num = tid;
+            thread_attach();
 
             for(unsigned int i = tid * part; i < (tid + 1) * part; ++i){
                 tree.add(elements[i]);
             }
+
+            thread_detach();
         }));
     }
 
@@ -425,7 +814,9 @@ void random_construction_bench(){
 
         for(int i = 0; i < REPEAT; ++i){
             RANDOM_CONSTRUCTION(skiplist::SkipList, "skiplist", size);
+            RANDOM_CONSTRUCTION(skiplist::UnrolledSkipList, "unrolled", size);
             RANDOM_CONSTRUCTION(nbbst::NBBST, "nbbst", size);
+            RANDOM_CONSTRUCTION(chromatic::ChromaticTree, "chromatic", size);
             RANDOM_CONSTRUCTION(avltree::AVLTree, "avltree", size);
             RANDOM_CONSTRUCTION(lfmst::MultiwaySearchTree, "lfmst", size);
             RANDOM_CONSTRUCTION(cbtree::CBTree, "cbtree", size);
@@ -452,11 +843,13 @@ void seq_removal_bench(const std::string& name, unsigned int size, Results& resu
     std::vector<std::thread> pool;
     for(unsigned int tid = 0; tid < Threads; ++tid){
         pool.push_back(std::thread([&tree, part, size, tid](){
-            thread_num = tid;
+            thread_attach();
 
             for(unsigned int i = tid * part; i < (tid + 1) * part; ++i){
                 tree.remove(i);
             }
+
+            thread_detach();
         }));
     }
 
@@ -490,7 +883,9 @@ void seq_removal_bench(){
         
         for(int i = 0; i < REPEAT; ++i){
             SEQUENTIAL_REMOVAL(skiplist::SkipList, "skiplist", size);
+            SEQUENTIAL_REMOVAL(skiplist::UnrolledSkipList, "unrolled", size);
             SEQUENTIAL_REMOVAL(nbbst::NBBST, "nbbst", size);
+            SEQUENTIAL_REMOVAL(chromatic::ChromaticTree, "chromatic", size);
             SEQUENTIAL_REMOVAL(avltree::AVLTree, "avltree", size);
             SEQUENTIAL_REMOVAL(lfmst::MultiwaySearchTree, "lfmst", size);
             SEQUENTIAL_REMOVAL(cbtree::CBTree, "cbtree", size);
@@ -513,7 +908,9 @@ void seq_removal_bench(){
         
         for(int i = 0; i < REPEAT; ++i){
             SEQUENTIAL_REMOVAL(skiplist::SkipList, "skiplist", size);
+            SEQUENTIAL_REMOVAL(skiplist::UnrolledSkipList, "unrolled", size);
             //Too slow SEQUENTIAL_REMOVAL(nbbst::NBBST, "NBBST", size);
+            SEQUENTIAL_REMOVAL(chromatic::ChromaticTree, "chromatic", size);
             SEQUENTIAL_REMOVAL(avltree::AVLTree, "avltree", size);
             SEQUENTIAL_REMOVAL(lfmst::MultiwaySearchTree, "lfmst", size);
             SEQUENTIAL_REMOVAL(cbtree::CBTree, "cbtree", size);
@@ -547,11 +944,13 @@ void random_removal_bench(const std::string& name, unsigned int size, Results& r
     std::vector<std::thread> pool;
     for(unsigned int tid = 0; tid < Threads; ++tid){
         pool.push_back(std::thread([&tree, &elements, part, size, tid](){
-            thread_num = tid;
+            thread_attach();
 
             for(unsigned int i = tid * part; i < (tid + 1) * part; ++i){
                 tree.remove(elements[i]);
             }
+
+            thread_detach();
         }));
     }
 
@@ -585,7 +984,9 @@ void random_removal_bench(){
 
         for(int i = 0; i < REPEAT; ++i){
             RANDOM_REMOVAL(skiplist::SkipList, "skiplist", size);
+            RANDOM_REMOVAL(skiplist::UnrolledSkipList, "unrolled", size);
             RANDOM_REMOVAL(nbbst::NBBST, "nbbst", size);
+            RANDOM_REMOVAL(chromatic::ChromaticTree, "chromatic", size);
             RANDOM_REMOVAL(avltree::AVLTree, "avltree", size);
             RANDOM_REMOVAL(lfmst::MultiwaySearchTree, "lfmst", size);
             RANDOM_REMOVAL(cbtree::CBTree, "cbtree", size);
@@ -598,13 +999,13 @@ void random_removal_bench(){
 }
 
 template<typename Tree, unsigned int Threads>
-void search_bench(const std::string& name, unsigned int size, Tree& tree, Results& results){
+unsigned long search_bench(const std::string& name, unsigned int size, Tree& tree, Results& results){
     Clock::time_point t0 = Clock::now();
 
     std::vector<std::thread> pool;
     for(unsigned int tid = 0; tid < Threads; ++tid){
         pool.push_back(std::thread([&tree, size, tid](){
-            thread_num = tid;
+            thread_attach();
     
             std::mt19937_64 engine(time(0) + tid);
             std::uniform_int_distribution<int> distribution(0, size);
@@ -612,6 +1013,8 @@ void search_bench(const std::string& name, unsigned int size, Tree& tree, Result
             for(int s = 0; s < SEARCH_BENCH_OPERATIONS; ++s){
                 tree.contains(distribution(engine));
             }
+
+            thread_detach();
         }));
     }
 
@@ -624,6 +1027,8 @@ void search_bench(const std::string& name, unsigned int size, Tree& tree, Result
 
     std::cout << name << "-" << size << " search througput with " << Threads << " threads = " << throughput << " operations / ms" << std::endl;
     results.add_result(name, throughput);
+
+    return throughput;
 }
 
 template<typename Tree>
@@ -648,17 +1053,19 @@ void fill_sequential(Tree& tree, unsigned int size){
 }
 
 template<typename Tree, unsigned int Threads>
-void search_random_bench(const std::string& name, unsigned int size, Results& results){
+unsigned long search_random_bench(const std::string& name, unsigned int size, Results& results){
     Tree tree;
     
     fill_random(tree, size);
     
-    search_bench<Tree, Threads>(name, size, tree, results);
+    unsigned long throughput = search_bench<Tree, Threads>(name, size, tree, results);
 
     //Empty the tree
     for(unsigned int i = 0; i < size; ++i){
         tree.remove(i);
     }
+
+    return throughput;
 }
 
 #define SEARCH_RANDOM(type, name, size)\
@@ -683,7 +1090,9 @@ void search_random_bench(){
 
         for(int i = 0; i < REPEAT; ++i){
             SEARCH_RANDOM(skiplist::SkipList, "skiplist", size);
+            SEARCH_RANDOM(skiplist::UnrolledSkipList, "unrolled", size);
             SEARCH_RANDOM(nbbst::NBBST, "nbbst", size);
+            SEARCH_RANDOM(chromatic::ChromaticTree, "chromatic", size);
             SEARCH_RANDOM(avltree::AVLTree, "avltree", size);
             SEARCH_RANDOM(lfmst::MultiwaySearchTree, "lfmst", size);
             SEARCH_RANDOM(cbtree::CBTree, "cbtree", size);
@@ -731,7 +1140,9 @@ void search_sequential_bench(){
 
         for(int i = 0; i < REPEAT; ++i){
             SEARCH_SEQUENTIAL(skiplist::SkipList, "skiplist", size);
+            SEARCH_SEQUENTIAL(skiplist::UnrolledSkipList, "unrolled", size);
             SEARCH_SEQUENTIAL(nbbst::NBBST, "nbbst", size);
+            SEARCH_SEQUENTIAL(chromatic::ChromaticTree, "chromatic", size);
             SEARCH_SEQUENTIAL(avltree::AVLTree, "avltree", size);
             SEARCH_SEQUENTIAL(lfmst::MultiwaySearchTree, "lfmst", size);
             SEARCH_SEQUENTIAL(cbtree::CBTree, "cbtree", size);
@@ -754,7 +1165,9 @@ void search_sequential_bench(){
 
         for(int i = 0; i < REPEAT; ++i){
             SEARCH_SEQUENTIAL(skiplist::SkipList, "skiplist", size);
+            SEARCH_SEQUENTIAL(skiplist::UnrolledSkipList, "unrolled", size);
             //The nbbst is far too slow SEARCH_SEQUENTIAL(nbbst::NBBST, "nbbst", size);
+            SEARCH_SEQUENTIAL(chromatic::ChromaticTree, "chromatic", size);
             SEARCH_SEQUENTIAL(avltree::AVLTree, "avltree", size);
             SEARCH_SEQUENTIAL(lfmst::MultiwaySearchTree, "lfmst", size);
             SEARCH_SEQUENTIAL(cbtree::CBTree, "cbtree", size);
@@ -766,11 +1179,375 @@ void search_sequential_bench(){
     }
 }
 
+/*!
+ * Compare the search performances of a tree whose nodes are carved from 4KB pages and 
+ * of the same tree whose nodes are carved from 2MB pages. The second one is stored 
+ * under the name of the tree suffixed by "-huge". 
+ */
+template<typename Tree, unsigned int Threads>
+void search_huge_bench(const std::string& name, unsigned int size, Results& results){
+    huge_slabs = false;
+    unsigned long small = search_random_bench<Tree, Threads>(name, size, results);
+
+    huge_slabs = true;
+    unsigned long huge = search_random_bench<Tree, Threads>(name + "-huge", size, results);
+
+    huge_slabs = false;
+
+    std::cout << name << "-" << size << " search speedup with huge pages with " << Threads << " threads = " << (static_cast<double>(huge) / small) << std::endl;
+}
+
+#define SEARCH_HUGE(type, name, size)\
+    search_huge_bench<type<int, 1>, 1>(name, size, results);\
+    search_huge_bench<type<int, 2>, 2>(name, size, results);\
+    search_huge_bench<type<int, 3>, 3>(name, size, results);\
+    search_huge_bench<type<int, 4>, 4>(name, size, results);\
+    search_huge_bench<type<int, 8>, 8>(name, size, results);
+
+void search_huge_bench(){
+    std::cout << "Bench the search performances of each data structure with random insertion, with and without huge pages" << std::endl;
+
+    std::vector<int> sizes = {1000000, 10000000};
+
+    for(auto size : sizes){
+        std::stringstream name;
+        name << "random-search-huge-" << size;
+
+        Results results;
+        results.start(name.str());
+        results.set_max(5);
+
+        for(int i = 0; i < REPEAT; ++i){
+            SEARCH_HUGE(skiplist::SkipList, "skiplist", size);
+            SEARCH_HUGE(skiplist::UnrolledSkipList, "unrolled", size);
+            SEARCH_HUGE(nbbst::NBBST, "nbbst", size);
+            SEARCH_HUGE(chromatic::ChromaticTree, "chromatic", size);
+            SEARCH_HUGE(avltree::AVLTree, "avltree", size);
+            SEARCH_HUGE(lfmst::MultiwaySearchTree, "lfmst", size);
+            SEARCH_HUGE(cbtree::CBTree, "cbtree", size);
+        }
+
+        results.finish();
+
+        std::cout << "bench is over" << std::endl;
+    }
+}
+
+template<typename Tree, unsigned int Threads>
+void latency_bench(const std::string& name, Results& results){
+    Tree tree;
+
+    std::vector<unsigned long> latencies[Threads];
+
+    std::vector<std::thread> pool;
+    for(unsigned int tid = 0; tid < Threads; ++tid){
+        pool.push_back(std::thread([&tree, &latencies, tid](){
+            thread_attach();
+
+            std::mt19937_64 engine(time(0) + tid);
+            std::uniform_int_distribution<int> distribution(0, std::numeric_limits<int>::max() - 1);
+
+            latencies[tid].reserve(LATENCY_BENCH_OPERATIONS);
+
+            //Each value is removed once inserted, so that the nodes are continuously released
+            for(int i = 0; i < LATENCY_BENCH_OPERATIONS; ++i){
+                int value = distribution(engine);
+
+                Clock::time_point t0 = Clock::now();
+                tree.add(value);
+                Clock::time_point t1 = Clock::now();
+
+                latencies[tid].push_back(std::chrono::duration_cast<nanoseconds>(t1 - t0).count());
+
+                tree.remove(value);
+            }
+
+            thread_detach();
+        }));
+    }
+
+    for_each(pool.begin(), pool.end(), [](std::thread& t){t.join();});
+
+    std::vector<unsigned long> all;
+    for(unsigned int tid = 0; tid < Threads; ++tid){
+        all.insert(all.end(), latencies[tid].begin(), latencies[tid].end());
+    }
+
+    std::sort(all.begin(), all.end());
+
+    unsigned long p99 = all[all.size() * 99 / 100];
+    unsigned long p999 = all[all.size() * 999 / 1000];
+
+    std::cout << name << " insert latency with " << Threads << " threads: p99 = " << p99 << " ns, p999 = " << p999 << " ns" << std::endl;
+
+    results.add_result(name + "-p99", p99);
+    results.add_result(name + "-p999", p999);
+}
+
+#define LATENCY(type, name)\
+    latency_bench<type<int, 1>, 1>(name, results);\
+    latency_bench<type<int, 2>, 2>(name, results);\
+    latency_bench<type<int, 4>, 4>(name, results);\
+    latency_bench<type<int, 8>, 8>(name, results);
+
+void latency_bench(){
+    std::cout << "Bench the insertion latency with the nodes reclaimed inline and on a helper thread" << std::endl;
+
+    Results results;
+    results.start("insert-latency");
+    results.set_max(4);
+
+    for(int i = 0; i < REPEAT; ++i){
+        background_reclamation = false;
+
+        LATENCY(skiplist::SkipList, "skiplist");
+        LATENCY(nbbst::NBBST, "nbbst");
+        LATENCY(chromatic::ChromaticTree, "chromatic");
+        LATENCY(avltree::AVLTree, "avltree");
+        LATENCY(lfmst::MultiwaySearchTree, "lfmst");
+        LATENCY(cbtree::CBTree, "cbtree");
+
+        background_reclamation = true;
+
+        LATENCY(skiplist::SkipList, "skiplist-background");
+        LATENCY(nbbst::NBBST, "nbbst-background");
+        LATENCY(avltree::AVLTree, "avltree-background");
+        LATENCY(lfmst::MultiwaySearchTree, "lfmst-background");
+        LATENCY(cbtree::CBTree, "cbtree-background");
+    }
+
+    background_reclamation = false;
+
+    results.finish();
+
+    std::cout << "bench is over" << std::endl;
+}
+
+/*!
+ * Node published in the hazard pointers benchmark. 
+ */
+struct HazardBenchNode {
+    int key;
+};
+
+/*!
+ * Hazard pointers stored in a single dense array, as they were before being moved to 
+ * per-thread records. Several threads share the same cache line when Size is small. 
+ */
+template<typename Node, unsigned int Threads, unsigned int Size>
+class DenseHazardPointers {
+    public:
+        DenseHazardPointers(){
+            for(unsigned int tid = 0; tid <= Threads; ++tid){
+                for(unsigned int i = 0; i < Size; ++i){
+                    Pointers[tid][i] = nullptr;
+                }
+            }
+        }
+
+        void publish(Node* node, unsigned int i){
+            Pointers[thread_num][i] = node;
+        }
+
+        void releaseAll(){
+            for(unsigned int i = 0; i < Size; ++i){
+                Pointers[thread_num][i] = nullptr;
+            }
+        }
+
+    private:
+        Node* Pointers[Threads + 1][Size];     //The main thread keeps the first slot
+};
+
+template<typename Hazard, unsigned int Threads>
+void hazard_bench(const std::string& name, Results& results){
+    Hazard hazard;
+
+    std::vector<HazardBenchNode> nodes(HAZARD_BENCH_NODES);
+
+    Clock::time_point t0 = Clock::now();
+
+    std::vector<std::thread> pool;
+    for(unsigned int tid = 0; tid < Threads; ++tid){
+        pool.push_back(std::thread([&hazard, &nodes, tid](){
+            thread_attach();
+
+            for(int i = 0; i < OPERATIONS; ++i){
+                //Publish pred, curr and succ as a step of SkipList::find does
+                for(unsigned int j = 0; j < 3; ++j){
+                    hazard.publish(&nodes[(i + j) % HAZARD_BENCH_NODES], j);
+
+                    //Like in a traversal, the publication must be done before the node is read
+                    asm volatile("" ::: "memory");
+                }
+
+                hazard.releaseAll();
+            }
+
+            thread_detach();
+        }));
+    }
+
+    for_each(pool.begin(), pool.end(), [](std::thread& t){t.join();});
+
+    Clock::time_point t1 = Clock::now();
+
+    milliseconds ms = std::chrono::duration_cast<milliseconds>(t1 - t0);
+    unsigned long throughput = (Threads * OPERATIONS) / ms.count();
+
+    std::cout << name << " hazard publication througput with " << Threads << " threads = " << throughput << " operations / ms" << std::endl;
+    results.add_result(name, throughput);
+}
+
+#define HAZARD(type, name)\
+    hazard_bench<type<HazardBenchNode, 1, 3>, 1>(name, results);\
+    hazard_bench<type<HazardBenchNode, 2, 3>, 2>(name, results);\
+    hazard_bench<type<HazardBenchNode, 4, 3>, 4>(name, results);\
+    hazard_bench<type<HazardBenchNode, 8, 3>, 8>(name, results);\
+    hazard_bench<type<HazardBenchNode, 16, 3>, 16>(name, results);\
+    hazard_bench<type<HazardBenchNode, 32, 3>, 32>(name, results);
+
+void hazard_bench(){
+    std::cout << "Bench the publication of hazard pointers with a dense array and with per-thread records" << std::endl;
+
+    Results results;
+    results.start("hazard-publication");
+    results.set_max(6);
+
+    for(int i = 0; i < REPEAT; ++i){
+        HAZARD(DenseHazardPointers, "dense");
+        HAZARD(HazardManager, "records");
+    }
+
+    results.finish();
+
+    std::cout << "bench is over" << std::endl;
+}
+
+//Indicates that the stalled thread must stay in its signal handler
+static std::atomic<bool> stalled(false);
+
+static void stall_handler(int /*signal*/){
+    struct timespec pause = {0, 100000};
+
+    while(stalled.load()){
+        nanosleep(&pause, nullptr);
+    }
+}
+
+template<typename Tree, unsigned int Threads>
+void stall_bench(const std::string& name, Results& results){
+    Tree tree;
+
+    std::atomic<bool> stop(false);
+
+    //The stalled thread continuously updates the structure, so that it is very likely suspended in an operation
+    std::thread staller([&tree, &stop](){
+        thread_attach();
+
+        std::mt19937_64 engine(time(0));
+        std::uniform_int_distribution<int> distribution(0, std::numeric_limits<int>::max() - 1);
+
+        while(!stop.load()){
+            int value = distribution(engine);
+
+            tree.add(value);
+            tree.remove(value);
+        }
+
+        thread_detach();
+    });
+
+    std::this_thread::sleep_for(milliseconds(10));
+
+    struct sigaction action;
+    action.sa_handler = stall_handler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = 0;
+    sigaction(SIGUSR1, &action, nullptr);
+
+    stalled.store(true);
+    pthread_kill(staller.native_handle(), SIGUSR1);
+
+    Clock::time_point t0 = Clock::now();
+
+    std::vector<std::thread> pool;
+    for(unsigned int tid = 0; tid < Threads; ++tid){
+        pool.push_back(std::thread([&tree, tid](){
+            thread_attach();
+
+            std::mt19937_64 engine(time(0) + tid);
+            std::uniform_int_distribution<int> distribution(0, std::numeric_limits<int>::max() - 1);
+
+            //Each value is removed once inserted, so that the nodes are continuously released
+            for(int i = 0; i < OPERATIONS / 2; ++i){
+                int value = distribution(engine);
+
+                tree.add(value);
+                tree.remove(value);
+            }
+
+            thread_detach();
+        }));
+    }
+
+    for_each(pool.begin(), pool.end(), [](std::thread& t){t.join();});
+
+    Clock::time_point t1 = Clock::now();
+
+    //The released nodes still waiting while the thread is stalled
+    ReclamationStats stats = tree.reclamation_stats();
+    unsigned long unreclaimed = stats.retired - stats.reclaimed;
+
+    stalled.store(false);
+    stop.store(true);
+    staller.join();
+
+    milliseconds ms = std::chrono::duration_cast<milliseconds>(t1 - t0);
+    unsigned long throughput = (Threads * OPERATIONS) / ms.count();
+
+    std::cout << name << " with a stalled thread and " << Threads << " threads: " << throughput << " operations / ms, " << unreclaimed << " unreclaimed nodes" << std::endl;
+
+    results.add_result(name, throughput);
+    results.add_result(name + "-unreclaimed", unreclaimed);
+}
+
+//The structures have a record more for the stalled thread
+#define STALL(type, reclamation, name)\
+    stall_bench<type<int, 2, reclamation>, 1>(name, results);\
+    stall_bench<type<int, 3, reclamation>, 2>(name, results);\
+    stall_bench<type<int, 5, reclamation>, 4>(name, results);\
+    stall_bench<type<int, 9, reclamation>, 8>(name, results);
+
+void stall_bench(){
+    std::cout << "Bench the epochs and the intervals while a thread is stalled in an operation" << std::endl;
+
+    Results results;
+    results.start("stalled-thread");
+    results.set_max(4);
+
+    //Not with hazard pointers, the traversals of the structures do not validate all the references they publish, 
+    //so the nodes reused while a thread is stalled in an operation end up being read by the others
+    for(int i = 0; i < REPEAT; ++i){
+        STALL(skiplist::SkipList, Epochs, "skiplist-epoch");
+        STALL(skiplist::SkipList, Intervals, "skiplist-interval");
+        STALL(lfmst::MultiwaySearchTree, Epochs, "lfmst-epoch");
+        STALL(lfmst::MultiwaySearchTree, Intervals, "lfmst-interval");
+    }
+
+    results.finish();
+
+    std::cout << "bench is over" << std::endl;
+}
+
 void bench(){
     std::cout << "Tests the performance of the different versions" << std::endl;
 
     //Launch the random benchmark
     random_bench();
+    insert_bench();
+    range_bench();
+    scheduler_bench();
     skewed_bench();
 
     //Launch the construction benchmark
@@ -784,4 +1561,14 @@ void bench(){
     //Launch the search benchmark
     search_random_bench();
     search_sequential_bench();
+    search_huge_bench();
+
+    //Launch the hazard pointers benchmark
+    hazard_bench();
+
+    //Launch the latency benchmark
+    latency_bench();
+
+    //Launch the stalled thread benchmark
+    stall_bench();
 }
@@ -2,6 +2,7 @@
 
 #include "test.hpp"
 #include "bench.hpp"
+#include "ThreadRegistry.hpp"
 
 /*!
  * Launch the test indicated by the arguments.
@@ -9,6 +10,9 @@
 int main(int argc, const char* argv[]) {
     std::cout << "Concurrent Binary Trees test" << std::endl;
 
+    //The main thread also fills and empties the structures
+    thread_attach();
+
     //By default launch perf test
     if(argc == 1){
         bench();
@@ -19,6 +23,8 @@ int main(int argc, const char* argv[]) {
             bench();
         } else if(arg == "-test"){
             test();
+        } else if(arg == "-numa"){
+            numa_bench();
         } else if(arg == "-all"){
             test();
             bench();
@@ -65,16 +65,88 @@ void memory_init(){
 #include <sstream>
 #include <algorithm>
 #include <set>
+#include <cstdlib>
+#include <fstream>
+
+#include <unistd.h>
+#include <sys/resource.h>
 
 #include "Results.hpp"
+#include "ThreadRegistry.hpp"
+#include "SlabArena.hpp"
 
 //Include all the trees implementations
 #include "skiplist/SkipList.hpp"
+#include "skiplist/UnrolledSkipList.hpp"
 #include "nbbst/NBBST.hpp"
+#include "nmbst/NMBST.hpp"
+#include "chromatic/ChromaticTree.hpp"
 #include "avltree/AVLTree.hpp"
 #include "lfmst/MultiwaySearchTree.hpp"
 #include "cbtree/CBTree.hpp"
 
+/*!
+ * Return the memory currently used, allocated with malloc or mapped for the slabs of nodes. 
+ */
+unsigned long used_memory(){
+    return allocated + slab_bytes.load();
+}
+
+/*!
+ * Return the memory of the process resident in RAM, read from /proc/self/statm, 0 if it is not available. 
+ * Unlike used_memory(), only the touched pages are counted and the pages given back to the system are not. 
+ */
+unsigned long resident_memory(){
+    std::ifstream statm("/proc/self/statm");
+
+    unsigned long total = 0;
+    unsigned long resident = 0;
+
+    if(!(statm >> total >> resident)){
+        return 0;
+    }
+
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+/*!
+ * Return the highest memory of the process resident in RAM since its start. 
+ */
+unsigned long peak_resident_memory(){
+    struct rusage usage;
+
+    if(getrusage(RUSAGE_SELF, &usage)){
+        return 0;
+    }
+
+    //Linux gives the size in kilobytes
+    return usage.ru_maxrss * 1024ul;
+}
+
+/*!
+ * Return the resident memory gained since the given resident memory, 0 if some memory has been given back since. 
+ */
+unsigned long resident_since(unsigned long start){
+    unsigned long resident = resident_memory();
+
+    return resident > start ? resident - start : 0;
+}
+
+/*!
+ * Print and store the peak memory usage of a tree, once filled, and its steady-state memory usage, once emptied. 
+ * The steady-state results are stored under the name of the tree suffixed by "-steady". The resident memory
+ * gained by the process is stored under the name of the tree suffixed by "-rss" and "-rss-steady". 
+ */
+void add_usage(const std::string& name, unsigned int size, unsigned long peak, unsigned long steady, 
+        unsigned long peak_resident, unsigned long steady_resident, Results& results){
+    std::cout << name << "-" << size << " is using " << (peak / 1024) << " KB (" << (steady / 1024) << " KB once emptied), " 
+        << (peak_resident / 1024) << " KB resident (" << (steady_resident / 1024) << " KB once emptied)" << std::endl;
+    results.add_result(name, (peak / 1024.0));
+    results.add_result(name + "-steady", (steady / 1024.0));
+    results.add_result(name + "-rss", (peak_resident / 1024.0));
+    results.add_result(name + "-rss-steady", (steady_resident / 1024.0));
+}
+
 /*!
  * Launch the memory test on the given Tree. 
  * \param Tree The type of the tree. 
@@ -94,6 +166,7 @@ void memory(const std::string& name, unsigned int size, Results& results){
 
     //For now on, count all the allocations
     allocated = 0;
+    unsigned long resident = resident_memory();
 
     Tree* alloc_tree = new Tree();
     Tree& tree = *alloc_tree;
@@ -103,16 +176,16 @@ void memory(const std::string& name, unsigned int size, Results& results){
         tree.add(elements[i]);
     }
     
-    unsigned long usage = allocated;
-    
-    std::cout << name << "-" << size << " is using " << (usage / 1024) << " KB" << std::endl;
-    results.add_result(name, (usage / 1024.0));
+    unsigned long peak = used_memory();
+    unsigned long peak_resident = resident_since(resident);
     
     //Empty the tree
     for(unsigned int i = 0; i < size; ++i){
         tree.remove(i);
     }
 
+    add_usage(name, size, peak, used_memory(), peak_resident, resident_since(resident), results);
+
     delete alloc_tree;
 }
 
@@ -146,6 +219,7 @@ void memory_high(const std::string& name, unsigned int size, Results& results){
 
     //For now on, count all the allocations
     allocated = 0;
+    unsigned long resident = resident_memory();
 
     Tree* alloc_tree = new Tree();
     Tree& tree = *alloc_tree;
@@ -154,16 +228,16 @@ void memory_high(const std::string& name, unsigned int size, Results& results){
         tree.add(i);
     }
 
-    unsigned long usage = allocated;
-    
-    std::cout << name << "-" << size << " is using " << (usage / 1024) << " KB" << std::endl;
-    results.add_result(name, (usage / 1024.0));
+    unsigned long peak = used_memory();
+    unsigned long peak_resident = resident_since(resident);
     
     //Empty the tree
     for(auto i : vector_elements){
         tree.remove(i);
     }
 
+    add_usage(name, size, peak, used_memory(), peak_resident, resident_since(resident), results);
+
     delete alloc_tree;
 }
 
@@ -176,13 +250,18 @@ int main(int argc, const char* argv[]) {
     std::vector<unsigned int> little_sizes = {1000, 10000, 100000};
     std::vector<unsigned int> big_sizes = {1000000, 10000000};
 
-    thread_num = 0;
+    thread_attach();
 
     if(argc == 1){
         std::cout << "low or high argument needed" << std::endl;
     } else {
         std::string arg = argv[1];
 
+        //The optional second argument is the high-water mark of the free nodes of each manager
+        if(argc > 2){
+            default_high_water = atoi(argv[2]);
+        }
+
         if(arg == "low"){
             std::cout << "Test the normal memory consumption of each version" << std::endl;
 
@@ -192,7 +271,10 @@ int main(int argc, const char* argv[]) {
 
             for(auto size : little_sizes){
                 memory<skiplist::SkipList<int, 32>>("skiplist", size, results);
+                memory<skiplist::UnrolledSkipList<int, 32>>("unrolled", size, results);
                 memory<nbbst::NBBST<int, 32>>("nbbst", size, results);
+                memory<nmbst::NMBST<int, 32>>("nmbst", size, results);
+                memory<chromatic::ChromaticTree<int, 32>>("chromatic", size, results);
                 memory<lfmst::MultiwaySearchTree<int, 32>>("lfmst", size, results);
                 memory<avltree::AVLTree<int, 32>>("avltree", size, results);
                 memory<cbtree::CBTree<int, 32>>("cbtree", size, results);
@@ -205,7 +287,10 @@ int main(int argc, const char* argv[]) {
 
             for(auto size : big_sizes){
                 memory<skiplist::SkipList<int, 32>>("skiplist", size, results);
+                memory<skiplist::UnrolledSkipList<int, 32>>("unrolled", size, results);
                 memory<nbbst::NBBST<int, 32>>("nbbst", size, results);
+                memory<nmbst::NMBST<int, 32>>("nmbst", size, results);
+                memory<chromatic::ChromaticTree<int, 32>>("chromatic", size, results);
                 memory<lfmst::MultiwaySearchTree<int, 32>>("lfmst", size, results);
                 memory<avltree::AVLTree<int, 32>>("avltree", size, results);
                 memory<cbtree::CBTree<int, 32>>("cbtree", size, results);
@@ -221,7 +306,10 @@ int main(int argc, const char* argv[]) {
 
             for(auto size : little_sizes){
                 memory_high<skiplist::SkipList<int, 32>>("skiplist", size, results);
+                memory_high<skiplist::UnrolledSkipList<int, 32>>("unrolled", size, results);
                 memory_high<nbbst::NBBST<int, 32>>("nbbst", size, results);
+                memory_high<nmbst::NMBST<int, 32>>("nmbst", size, results);
+                memory_high<chromatic::ChromaticTree<int, 32>>("chromatic", size, results);
                 memory_high<lfmst::MultiwaySearchTree<int, 32>>("lfmst", size, results);
                 memory_high<avltree::AVLTree<int, 32>>("avltree", size, results);
                 memory_high<cbtree::CBTree<int, 32>>("cbtree", size, results);
@@ -234,7 +322,10 @@ int main(int argc, const char* argv[]) {
 
             for(auto size : big_sizes){
                 memory_high<skiplist::SkipList<int, 32>>("skiplist", size, results);
+                memory_high<skiplist::UnrolledSkipList<int, 32>>("unrolled", size, results);
                 memory_high<nbbst::NBBST<int, 32>>("nbbst", size, results);
+                memory_high<nmbst::NMBST<int, 32>>("nmbst", size, results);
+                memory_high<chromatic::ChromaticTree<int, 32>>("chromatic", size, results);
                 memory_high<lfmst::MultiwaySearchTree<int, 32>>("lfmst", size, results);
                 memory_high<avltree::AVLTree<int, 32>>("avltree", size, results);
                 memory_high<cbtree::CBTree<int, 32>>("cbtree", size, results);
@@ -244,6 +335,8 @@ int main(int argc, const char* argv[]) {
         } else {
             std::cout << "incorrect argument" << std::endl;
         }
+
+        std::cout << "The peak resident memory of the process is " << (peak_resident_memory() / 1024) << " KB" << std::endl;
     }
 
     end = true;
@@ -5,14 +5,20 @@
 #include <functional>
 #include <thread>
 #include <algorithm>
+#include <set>
 
 #include "test.hpp"
-#include "HazardManager.hpp" //To manipulate thread_num
+#include "ThreadRegistry.hpp" //To attach the threads
+#include "EpochManager.hpp"
+#include "IntervalManager.hpp"
 #include "tree_type_traits.hpp"
 
 //Include all the trees implementations
 #include "skiplist/SkipList.hpp"
+#include "skiplist/UnrolledSkipList.hpp"
 #include "nbbst/NBBST.hpp"
+#include "nmbst/NMBST.hpp"
+#include "chromatic/ChromaticTree.hpp"
 #include "avltree/AVLTree.hpp"
 #include "lfmst/MultiwaySearchTree.hpp"
 #include "cbtree/CBTree.hpp"
@@ -36,8 +42,6 @@ template<typename T>
 void testST(const std::string& name){
     std::cout << "Test single-threaded (with " << ST_N << " elements) " << name << std::endl;
 
-    thread_num = 0;
-    
     T tree;
     
     std::mt19937_64 engine(time(NULL));
@@ -152,7 +156,7 @@ void testMT(){
     std::vector<std::thread> pool;
     for(unsigned int i = 0; i < Threads; ++i){
         pool.push_back(std::thread([sequential_nodes, &tree, i](){
-            thread_num = i;
+            thread_attach();
 
             //Insert sequential numbers
             for(unsigned int j = i * sequential_nodes; j < (i + 1) * sequential_nodes; ++j){
@@ -167,6 +171,8 @@ void testMT(){
                 assert(tree.remove(j));   
                 assert(!tree.contains(j));
             }
+
+            thread_detach();
         }));
     }
 
@@ -177,12 +183,14 @@ void testMT(){
     
     for(unsigned int i = 0; i < Threads; ++i){
         pool.push_back(std::thread([sequential_nodes, &tree, i](){
-            thread_num = i;
+            thread_attach();
 
             //Verify that every numbers has been removed correctly
             for(unsigned int j = 0; j < Threads * sequential_nodes; ++j){
                 assert(!tree.contains(j));
             }
+
+            thread_detach();
         }));
     }
 
@@ -210,7 +218,7 @@ void testMT(){
 
     for(unsigned int i = 0; i < Threads; ++i){
         pool.push_back(std::thread([&tree, &fixed_points, i](){
-            thread_num = i;
+            thread_attach();
 
             std::vector<int> rand;
             
@@ -244,6 +252,8 @@ void testMT(){
             for(auto& value : rand){
                 tree.remove(value);
             }
+
+            thread_detach();
         }));
     }
 
@@ -254,6 +264,251 @@ void testMT(){
     std::cout << "Test with " << Threads << " threads passed succesfully" << std::endl;
 }
 
+/*!
+ * Test the range scans of the given structure, single-threaded then with threads updating 
+ * the elements outside of a fixed set while others scan it. 
+ * \param T The type of the structure.
+ * \param Threads The number of threads. 
+ */
+template<typename T, unsigned int Threads>
+void testRange(const std::string& name){
+    std::cout << "Test the range scans of " << name << std::endl;
+
+    T tree;
+    std::set<int> reference;
+
+    std::mt19937_64 engine(time(NULL));
+    std::uniform_int_distribution<int> distribution(0, 100000);
+    auto generator = std::bind(distribution, engine);
+
+    DEBUG("Scan the empty tree");
+
+    assert(tree.count_range(0, std::numeric_limits<int>::max() - 1) == 0);
+    assert(tree.count_range(0, std::numeric_limits<int>::max()) == 0);
+
+    DEBUG("Search a key greater than a full block of keys");
+
+    for(int number = -100; number < -84; ++number){
+        assert(tree.add(number));
+    }
+
+    assert(!tree.contains(0));
+    assert(!tree.remove(0));
+    assert(tree.add(0));
+    assert(tree.contains(0));
+    assert(tree.count_range(-100, std::numeric_limits<int>::max()) == 17);
+
+    for(int number = -100; number < -84; ++number){
+        assert(tree.remove(number));
+    }
+
+    assert(tree.remove(0));
+
+    DEBUG("Scan random ranges of random numbers");
+
+    for(unsigned int i = 0; i < ST_N; ++i){
+        int number = generator();
+
+        assert(tree.add(number) == reference.insert(number).second);
+    }
+
+    for(unsigned int i = 0; i < 1000; ++i){
+        int lo = generator();
+        int hi = lo + generator() / 100;
+
+        std::vector<int> keys;
+        tree.for_each_in_range(lo, hi, [&keys](int key){ keys.push_back(key); });
+
+        assert(std::equal(keys.begin(), keys.end(), reference.lower_bound(lo)));
+        assert(keys.size() == static_cast<std::size_t>(std::distance(reference.lower_bound(lo), reference.upper_bound(hi))));
+        assert(tree.count_range(lo, hi) == keys.size());
+        assert(tree.count_range(lo, std::numeric_limits<int>::max()) == static_cast<std::size_t>(std::distance(reference.lower_bound(lo), reference.end())));
+    }
+
+    for(int number : reference){
+        assert(tree.remove(number));
+    }
+
+    DEBUG("Scan the multiples of 4 while the other numbers are added and removed");
+
+    for(int number = 0; number < 100000; number += 4){
+        assert(tree.add(number));
+    }
+
+    std::vector<std::thread> pool;
+    for(unsigned int i = 0; i < Threads; ++i){
+        pool.push_back(std::thread([&tree, i](){
+            thread_attach();
+
+            std::mt19937_64 engine(time(0) + i);
+            std::uniform_int_distribution<int> distribution(0, 100000);
+
+            for(int n = 0; n < 10000; ++n){
+                int number = distribution(engine);
+
+                if(i % 2){
+                    //The multiples of 4 must be seen once and in order by all the scans
+                    int expected = (number + 3) / 4 * 4;
+
+                    tree.for_each_in_range(number, number + 1000, [&expected](int key){
+                        if(key % 4 == 0){
+                            assert(key == expected);
+                            expected += 4;
+                        }
+                    });
+                } else if(number % 4){
+                    tree.add(number);
+                    tree.remove(number);
+                }
+            }
+
+            thread_detach();
+        }));
+    }
+
+    for_each(pool.begin(), pool.end(), [](std::thread& t){t.join();});
+
+    std::cout << "Test passed successfully" << std::endl;
+}
+
+/*!
+ * Test the structure with increasing and nearby keys, each thread updating its own keys. 
+ * \param T The type of the structure.
+ * \param Threads The number of threads. 
+ */
+template<typename T, unsigned int Threads>
+void testLocality(const std::string& name){
+    std::cout << "Test the locality of " << name << std::endl;
+
+    T tree;
+
+    std::vector<std::thread> pool;
+    for(unsigned int i = 0; i < Threads; ++i){
+        pool.push_back(std::thread([&tree, i](){
+            thread_attach();
+
+            std::mt19937_64 engine(time(0) + i);
+            std::uniform_int_distribution<int> distribution(0, 9999);
+
+            //The keys of a thread are the numbers equal to i modulo Threads
+            for(int number = i; number < 10000 * static_cast<int>(Threads); number += Threads){
+                assert(tree.add(number));
+                assert(tree.contains(number));
+            }
+
+            for(int n = 0; n < 10000; ++n){
+                assert(tree.contains(distribution(engine) * Threads + i));
+            }
+
+            for(int number = 10000 * Threads - Threads + i; number >= 0; number -= Threads){
+                assert(tree.remove(number));
+                assert(!tree.contains(number));
+            }
+
+            thread_detach();
+        }));
+    }
+
+    for_each(pool.begin(), pool.end(), [](std::thread& t){t.join();});
+
+    std::cout << "Test passed successfully" << std::endl;
+}
+
+/*!
+ * Test the structure as a priority queue: a single thread must pop the elements in order and 
+ * several threads pushing and popping must pop each element once. 
+ * \param T The type of the structure.
+ * \param Threads The number of threads. 
+ */
+template<typename T, unsigned int Threads>
+void testPriority(const std::string& name){
+    std::cout << "Test the priority queue of " << name << std::endl;
+
+    T tree;
+    std::set<int> reference;
+
+    std::mt19937_64 engine(time(NULL));
+    std::uniform_int_distribution<int> distribution(0, std::numeric_limits<int>::max() - 1);
+    auto generator = std::bind(distribution, engine);
+
+    int key = 0;
+
+    DEBUG("Pop from the empty tree");
+
+    assert(!tree.peek_min(key));
+    assert(!tree.pop_min(key));
+
+    DEBUG("Pop random numbers in order");
+
+    for(unsigned int i = 0; i < ST_N; ++i){
+        int number = generator();
+
+        assert(tree.add(number) == reference.insert(number).second);
+    }
+
+    for(int number : reference){
+        int min = 0;
+
+        assert(tree.peek_min(min) && min == number);
+        assert(tree.pop_min(key) && key == number);
+        assert(!tree.contains(number));
+    }
+
+    assert(!tree.pop_min(key));
+
+    DEBUG("Push and pop in all the threads");
+
+    std::vector<std::vector<int>> popped(Threads);
+
+    std::vector<std::thread> pool;
+    for(unsigned int i = 0; i < Threads; ++i){
+        pool.push_back(std::thread([&tree, &popped, i](){
+            thread_attach();
+
+            //The keys of a thread are the numbers equal to i modulo Threads, pushed in random order
+            std::vector<int> numbers;
+            for(int number = i; number < 10000 * static_cast<int>(Threads); number += Threads){
+                numbers.push_back(number);
+            }
+
+            std::mt19937_64 engine(time(0) + i);
+            std::shuffle(numbers.begin(), numbers.end(), engine);
+
+            for(int number : numbers){
+                assert(tree.add(number));
+
+                int key = 0;
+                if(tree.pop_min(key)){
+                    popped[i].push_back(key);
+                }
+            }
+
+            thread_detach();
+        }));
+    }
+
+    for_each(pool.begin(), pool.end(), [](std::thread& t){t.join();});
+
+    std::vector<int> all;
+    for(std::vector<int>& keys : popped){
+        all.insert(all.end(), keys.begin(), keys.end());
+    }
+
+    while(tree.pop_min(key)){
+        all.push_back(key);
+    }
+
+    std::sort(all.begin(), all.end());
+
+    assert(all.size() == 10000 * Threads);
+
+    for(unsigned int i = 0; i < all.size(); ++i){
+        assert(all[i] == static_cast<int>(i));
+    }
+
+    std::cout << "Test passed successfully" << std::endl;
+}
+
 /*!
  * Launch all the tests on the given type.
  * \param type The type of the tree. 
@@ -272,13 +527,43 @@ void testMT(){
     testMT<type<int, 16>, 16>();\
     testMT<type<int, 32>, 32>();
 
+/*!
+ * Launch all the tests on the given type with another reclamation policy.
+ * \param type The type of the tree. 
+ * \param reclamation The reclamation policy.
+ * \param name The name of the tree. 
+ */
+#define TEST_RECLAMATION(type, reclamation, name) \
+    std::cout << "Test with 1 threads" << std::endl;\
+    testST<type<int, 1, reclamation>>(name);\
+    std::cout << "Test multi-threaded (with " << MT_N << " elements) " << name << std::endl;\
+    testMT<type<int, 2, reclamation>, 2>();\
+    testMT<type<int, 4, reclamation>, 4>();\
+    testMT<type<int, 8, reclamation>, 8>();\
+    testMT<type<int, 32, reclamation>, 32>();
+
 /*!
  * Test all the different versions.
  */
 void test(){
     std::cout << "Tests the different versions" << std::endl;
 
-    //TEST(skiplist::SkipList, "SkipList")
+    TEST(skiplist::SkipList, "SkipList")
+    testRange<skiplist::SkipList<int, 4>, 4>("SkipList");
+    testLocality<skiplist::SkipList<int, 4>, 4>("SkipList");
+    testPriority<skiplist::SkipList<int, 4>, 4>("SkipList");
+    TEST_RECLAMATION(skiplist::SkipList, Epochs, "SkipList with epochs")
+    testRange<skiplist::SkipList<int, 4, Epochs>, 4>("SkipList with epochs");
+    TEST_RECLAMATION(skiplist::SkipList, Intervals, "SkipList with intervals")
+    testRange<skiplist::SkipList<int, 4, Intervals>, 4>("SkipList with intervals");
+    TEST(skiplist::UnrolledSkipList, "Unrolled SkipList")
+    testRange<skiplist::UnrolledSkipList<int, 4>, 4>("Unrolled SkipList");
+    TEST_RECLAMATION(skiplist::UnrolledSkipList, Epochs, "Unrolled SkipList with epochs")
+    TEST(nmbst::NMBST, "Edge-Marking Binary Search Tree")
+    TEST(chromatic::ChromaticTree, "Chromatic Tree")
+    TEST_RECLAMATION(nbbst::NBBST, Epochs, "Non-Blocking Binary Search Tree with epochs")
+
+    //The hazard pointers version of NBBST is known to fail intermittently with 6 threads, it runs last
     TEST(nbbst::NBBST, "Non-Blocking Binary Search Tree")
     //TEST(avltree::AVLTree, "Optimistic AVL Tree")
     //TEST(lfmst::MultiwaySearchTree, "Lock Free Multiway Search Tree");